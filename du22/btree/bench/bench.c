@@ -0,0 +1,280 @@
+/*
+ * Měření rekurzivní a iterativní varianty binárního vyhledávacího stromu.
+ *
+ * Stejný zdrojový soubor se linkuje s btree-rec.c (bench_rec) i
+ * s btree-iter.c (bench_iter). Pro každé pořadí vkládaných klíčů a každou
+ * velikost stromu změří vkládání, vyhledávání, tři průchody, mazání a rušení
+ * stromu. Vypisuje čas na operaci, výpadky cache na operaci (přes
+ * perf_event, pokud to systém dovolí) a maximální obsazenou paměť.
+ *
+ * Použití: ./bench_rec [největší počet klíčů]
+ */
+#define _GNU_SOURCE
+
+#include "../btree.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef BENCH_NAME
+#define BENCH_NAME "bst"
+#endif
+
+// Sorted and zig-zag orders build a list, inserting into it is O(n^2)
+#define DEGENERATE_LIMIT 10000
+
+typedef enum shape { RANDOM, SORTED, ZIGZAG, BALANCED } shape_t;
+
+static const char *shape_names[] = {"random", "sorted", "zigzag", "balanced"};
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+  // xorshift64
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+static void shuffle(int *keys, int count)
+{
+  for (int i = count - 1; i > 0; i--) {
+    int j = rng_next() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+}
+
+/*
+ * Zapíše klíče z intervalu [low, high) v pořadí, ve kterém jejich vložení
+ * vytvoří vyvážený strom (vždy nejdřív prostřední klíč).
+ */
+static int fill_balanced(int *keys, int low, int high)
+{
+  if (low >= high) {
+    return 0;
+  }
+  int middle = low + (high - low) / 2;
+  keys[0] = middle;
+  int written = 1 + fill_balanced(keys + 1, low, middle);
+  return written + fill_balanced(keys + written, middle + 1, high);
+}
+
+static void fill_keys(int *keys, int count, shape_t shape)
+{
+  switch (shape) {
+  case RANDOM:
+    for (int i = 0; i < count; i++) {
+      keys[i] = i;
+    }
+    shuffle(keys, count);
+    break;
+  case SORTED:
+    for (int i = 0; i < count; i++) {
+      keys[i] = i;
+    }
+    break;
+  case ZIGZAG:
+    // 0, n-1, 1, n-2, ... every new node hangs below the previous one
+    for (int i = 0; i < count; i++) {
+      keys[i] = i % 2 == 0 ? i / 2 : count - 1 - i / 2;
+    }
+    break;
+  case BALANCED:
+    fill_balanced(keys, 0, count);
+    break;
+  }
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Měřený úsek: čas a čítač výpadků cache
+typedef struct measure {
+  int fd;        // perf_event čítač nebo -1
+  double start;  // začátek úseku v ns
+} measure_t;
+
+static int counter_open(void)
+{
+#ifdef __linux__
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+  return -1;
+#endif
+}
+
+static void measure_start(measure_t *measure)
+{
+#ifdef __linux__
+  if (measure->fd >= 0) {
+    ioctl(measure->fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(measure->fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+  measure->start = now_ns();
+}
+
+/*
+ * Ukončí úsek s count operacemi a vypíše jeden řádek výsledků.
+ */
+static void measure_stop(measure_t *measure, shape_t shape, int count,
+                         const char *op, int ops)
+{
+  double elapsed = now_ns() - measure->start;
+  long long misses = -1;
+#ifdef __linux__
+  if (measure->fd >= 0) {
+    ioctl(measure->fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(measure->fd, &misses, sizeof(misses)) != sizeof(misses)) {
+      misses = -1;
+    }
+  }
+#endif
+  printf("%-5s %-9s %9d %-10s %10.1f", BENCH_NAME, shape_names[shape], count,
+         op, elapsed / ops);
+  if (misses >= 0) {
+    printf(" %10.2f\n", (double)misses / ops);
+  } else {
+    printf(" %10s\n", "n/a");
+  }
+}
+
+/*
+ * Jedno měření pro daný tvar a velikost (běží v samostatném procesu, aby
+ * maximální obsazená paměť patřila jen jemu).
+ */
+static void run(shape_t shape, int count)
+{
+  int *keys = malloc(count * sizeof(int));
+  int *probes = malloc(count * sizeof(int));
+  if (keys == NULL || probes == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  bst_items_t items;
+  bst_items_init(&items);
+  bst_items_reserve(&items, count);
+  fill_keys(keys, count, shape);
+  fill_keys(probes, count, RANDOM);
+
+  // values are NULL so only the structure itself is measured
+  bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+  bst_node_content_t *found;
+  long checksum = 0;
+  measure_t measure = {.fd = counter_open(), .start = 0};
+  bst_node_t *tree;
+  bst_init(&tree);
+
+  measure_start(&measure);
+  for (int i = 0; i < count; i++) {
+    bst_insert(&tree, keys[i], empty);
+  }
+  measure_stop(&measure, shape, count, "insert", count);
+
+  measure_start(&measure);
+  for (int i = 0; i < count; i++) {
+    checksum += bst_search(tree, probes[i], &found);
+  }
+  measure_stop(&measure, shape, count, "search", count);
+
+  measure_start(&measure);
+  bst_preorder(tree, &items);
+  measure_stop(&measure, shape, count, "preorder", count);
+  items.size = 0;
+
+  measure_start(&measure);
+  bst_inorder(tree, &items);
+  measure_stop(&measure, shape, count, "inorder", count);
+  checksum += items.nodes[count - 1]->key;
+  items.size = 0;
+
+  measure_start(&measure);
+  bst_postorder(tree, &items);
+  measure_stop(&measure, shape, count, "postorder", count);
+  items.size = 0;
+
+  measure_start(&measure);
+  for (int i = 0; i < count / 2; i++) {
+    bst_delete(&tree, probes[i]);
+  }
+  measure_stop(&measure, shape, count, "delete", count / 2);
+
+  measure_start(&measure);
+  bst_dispose(&tree);
+  measure_stop(&measure, shape, count, "dispose", count - count / 2);
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  printf("%-5s %-9s %9d %-10s %10ld kB (checksum %ld)\n", BENCH_NAME,
+         shape_names[shape], count, "peak", usage.ru_maxrss, checksum);
+
+#ifdef __linux__
+  if (measure.fd >= 0) {
+    close(measure.fd);
+  }
+#endif
+  free(keys);
+  free(probes);
+  free(items.nodes);
+}
+
+int main(int argc, char *argv[])
+{
+  int max_count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (max_count < 1000) {
+    fprintf(stderr, "usage: %s [max count >= 1000]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  printf("%-5s %-9s %9s %-10s %10s %10s\n", "tree", "shape", "count", "op",
+         "ns/op", "miss/op");
+  for (shape_t shape = RANDOM; shape <= BALANCED; shape++) {
+    for (long count = 1000; count <= max_count; count *= 10) {
+      if ((shape == SORTED || shape == ZIGZAG) && count > DEGENERATE_LIMIT) {
+        printf("%-5s %-9s %9ld skipped, O(n^2) insert above %d keys\n",
+               BENCH_NAME, shape_names[shape], count, DEGENERATE_LIMIT);
+        continue;
+      }
+      fflush(stdout);
+      pid_t pid = fork();
+      if (pid == 0) {
+        run(shape, count);
+        fflush(stdout);
+        _exit(EXIT_SUCCESS);
+      }
+      if (pid < 0) {
+        run(shape, count); // no separate peak memory, but still measured
+      }
+      else {
+        waitpid(pid, NULL, 0);
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/*
+ * Měření sloupcového výstupu (bst_columns_t) proti poli ukazatelů na uzly
+ * (bst_items_t).
+ *
+ * Strom má klíče vložené v náhodném pořadí a každý uzel hodnotu typu
+ * INTEGER. Oba výstupy se naplní jedním inorder průchodem a pak se nad nimi
+ * opakovaně počítá součet hodnot a počet klíčů v intervalu. U bst_items_t
+ * to znamená skok přes ukazatel na uzel (a na hodnotu), u sloupců postupné
+ * čtení souvislého pole. Vypisuje čas jednoho průchodu v milisekundách.
+ *
+ * Použití: ./bench_columns [počet klíčů] [počet opakování]
+ */
+#define _GNU_SOURCE
+
+#include "../btree.h"
+#include "../columns.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+  // xorshift64
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int64_t items_sum(const bst_items_t *items)
+{
+  int64_t sum = 0;
+  for (int i = 0; i < items->size; i++) {
+    bst_node_content_t *content = &items->nodes[i]->content;
+    if (content->type == INTEGER && content->value != NULL) {
+      sum += *(int *)content->value;
+    }
+  }
+  return sum;
+}
+
+static int items_count_range(const bst_items_t *items, int low, int high)
+{
+  int count = 0;
+  for (int i = 0; i < items->size; i++) {
+    int key = items->nodes[i]->key;
+    count += key >= low && key <= high;
+  }
+  return count;
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  int repeat = argc > 2 ? atoi(argv[2]) : 20;
+  if (count < 1 || repeat < 1) {
+    fprintf(stderr, "usage: %s [count] [repeat]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int *keys = malloc(count * sizeof(int));
+  if (keys == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < count; i++) {
+    keys[i] = i;
+  }
+  for (int i = count - 1; i > 0; i--) {
+    int j = rng_next() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+
+  bst_node_t *tree;
+  bst_init(&tree);
+  for (int i = 0; i < count; i++) {
+    int *value = malloc(sizeof(int));
+    if (value == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    *value = keys[i] % 1000;
+    bst_node_content_t content = {.value = value, .type = INTEGER};
+    bst_insert(&tree, keys[i], content);
+  }
+
+  double start = now_ns();
+  bst_items_t items;
+  bst_items_init(&items);
+  bst_inorder(tree, &items);
+  double items_fill = (now_ns() - start) / 1e6;
+
+  start = now_ns();
+  bst_columns_t columns;
+  bst_columns_init(&columns, count);
+  bst_columns_export(tree, BST_INORDER, &columns);
+  double columns_fill = (now_ns() - start) / 1e6;
+
+  // the same quarter of the key range for both layouts
+  int low = count / 4;
+  int high = count / 2;
+  int64_t items_total = 0;
+  int64_t columns_total = 0;
+
+  start = now_ns();
+  for (int i = 0; i < repeat; i++) {
+    items_total += items_sum(&items);
+  }
+  double items_sum_ms = (now_ns() - start) / 1e6 / repeat;
+
+  start = now_ns();
+  for (int i = 0; i < repeat; i++) {
+    columns_total += bst_columns_sum(&columns);
+  }
+  double columns_sum_ms = (now_ns() - start) / 1e6 / repeat;
+
+  start = now_ns();
+  for (int i = 0; i < repeat; i++) {
+    items_total += items_count_range(&items, low, high);
+  }
+  double items_range_ms = (now_ns() - start) / 1e6 / repeat;
+
+  start = now_ns();
+  for (int i = 0; i < repeat; i++) {
+    columns_total += bst_columns_count_range(&columns, low, high);
+  }
+  double columns_range_ms = (now_ns() - start) / 1e6 / repeat;
+
+  printf("%d keys, %d passes\n", count, repeat);
+  printf("%-12s %10s %10s\n", "op", "items ms", "columns ms");
+  printf("%-12s %10.2f %10.2f\n", "fill", items_fill, columns_fill);
+  printf("%-12s %10.2f %10.2f\n", "sum", items_sum_ms, columns_sum_ms);
+  printf("%-12s %10.2f %10.2f %s\n", "count_range", items_range_ms,
+         columns_range_ms, items_total == columns_total ? "" : "(results differ!)");
+
+  free(items.nodes);
+  bst_columns_dispose(&columns);
+  bst_dispose(&tree);
+  free(keys);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/*
+ * Měření splay stromu proti obyčejnému a vyváženému stromu.
+ *
+ * Všechny tři stromy mají stejné klíče vložené v náhodném pořadí, vyvážený
+ * strom je navíc přestavěný bst_balance. Vyhledávání běží nad dvěma stopami:
+ * rovnoměrnou a Zipfovou (exponent s, hodnosti jsou náhodně přiřazené
+ * klíčům, takže časté klíče nejsou předem u kořene). Vypisuje čas na
+ * vyhledání a průměrnou hloubku nalezeného uzlu v plain a balanced stromu.
+ *
+ * Použití: ./bench_splay [počet klíčů] [exponent s]
+ */
+#define _GNU_SOURCE
+
+#include "../btree.h"
+#include "../splay.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define PROBE_COUNT 2000000
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+  // xorshift64
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+static double rng_unit(void)
+{
+  return (rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void shuffle(int *keys, int count)
+{
+  for (int i = count - 1; i > 0; i--) {
+    int j = rng_next() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Stopa se Zipfovým rozdělením: hodnost r má pravděpodobnost úměrnou 1/r^s,
+ * hodnost se vybírá binárním vyhledáním v distribuční funkci.
+ */
+static void fill_zipf(int *probes, const int *keys, int count, double s)
+{
+  double *cdf = malloc(count * sizeof(double));
+  if (cdf == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  double sum = 0;
+  for (int r = 0; r < count; r++) {
+    sum += 1.0 / pow(r + 1, s);
+    cdf[r] = sum;
+  }
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    double u = rng_unit() * sum;
+    int low = 0;
+    int high = count - 1;
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (cdf[mid] < u) {
+        low = mid + 1;
+      }
+      else {
+        high = mid;
+      }
+    }
+    probes[i] = keys[low];
+  }
+  free(cdf);
+}
+
+static double depth_of(bst_node_t *tree, int key)
+{
+  int depth = 0;
+  while (tree != NULL && tree->key != key) {
+    tree = key < tree->key ? tree->left : tree->right;
+    depth++;
+  }
+  return depth;
+}
+
+static void measure(const char *trace, bst_node_t **plain, bst_node_t **balanced,
+                    bst_node_t **splay, const int *probes)
+{
+  bst_node_content_t *content;
+  long found = 0;
+  double depth_plain = 0;
+  double depth_balanced = 0;
+  for (int i = 0; i < PROBE_COUNT; i += 64) {
+    depth_plain += depth_of(*plain, probes[i]);
+    depth_balanced += depth_of(*balanced, probes[i]);
+  }
+  depth_plain /= PROBE_COUNT / 64;
+  depth_balanced /= PROBE_COUNT / 64;
+
+  double start = now_ns();
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    found += bst_search(*plain, probes[i], &content);
+  }
+  double plain_ns = (now_ns() - start) / PROBE_COUNT;
+
+  start = now_ns();
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    found += bst_search(*balanced, probes[i], &content);
+  }
+  double balanced_ns = (now_ns() - start) / PROBE_COUNT;
+
+  start = now_ns();
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    found += bst_splay_search(splay, probes[i], &content);
+  }
+  double splay_ns = (now_ns() - start) / PROBE_COUNT;
+
+  printf("%-8s %10.1f %10.1f %10.1f %10.1f %10.1f %s\n", trace, plain_ns,
+         balanced_ns, splay_ns, depth_plain, depth_balanced,
+         found == 3L * PROBE_COUNT ? "" : "(missing keys!)");
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  double s = argc > 2 ? atof(argv[2]) : 1.1;
+  if (count < 1) {
+    fprintf(stderr, "usage: %s [count] [zipf exponent]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int *keys = malloc(count * sizeof(int));
+  int *probes = malloc(PROBE_COUNT * sizeof(int));
+  if (keys == NULL || probes == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < count; i++) {
+    keys[i] = 2 * i;
+  }
+  shuffle(keys, count);
+
+  bst_node_t *plain, *balanced, *splay;
+  bst_init(&plain);
+  bst_init(&balanced);
+  bst_init(&splay);
+  for (int i = 0; i < count; i++) {
+    bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+    bst_insert(&plain, keys[i], empty);
+    bst_insert(&balanced, keys[i], empty);
+    bst_splay_insert(&splay, keys[i], empty);
+  }
+  bst_balance(&balanced);
+
+  printf("%d keys, %d searches, zipf s = %.2f\n", count, PROBE_COUNT, s);
+  printf("%-8s %10s %10s %10s %10s %10s\n", "trace", "plain ns", "balanced ns",
+         "splay ns", "plain dep", "bal. dep");
+
+  shuffle(keys, count); // Zipf ranks go to random keys
+  for (int i = 0; i < PROBE_COUNT; i++) {
+    probes[i] = keys[rng_next() % count];
+  }
+  measure("uniform", &plain, &balanced, &splay, probes);
+  fill_zipf(probes, keys, count, s);
+  measure("zipf", &plain, &balanced, &splay, probes);
+
+  bst_dispose(&plain);
+  bst_dispose(&balanced);
+  bst_dispose(&splay);
+  free(keys);
+  free(probes);
+  return EXIT_SUCCESS;
+}
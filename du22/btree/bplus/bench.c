@@ -0,0 +1,140 @@
+/*
+ * Srovnání B+ stromu s binárním vyhledávacím stromem (rekurzivní varianta).
+ *
+ * Použití: ./bench [počet klíčů]
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include "bplus.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+  // xorshift64
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+static void shuffle(int *keys, int count)
+{
+  for (int i = count - 1; i > 0; i--) {
+    int j = rng_next() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+}
+
+static void count_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  (*(long *)ctx) += key;
+}
+
+static void report(const char *tree, const char *op, double start, int count)
+{
+  printf("%-5s %-8s %8.1f ns/op\n", tree, op, (now_ns() - start) / count);
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int *keys = malloc(count * sizeof(int));
+  int *probes = malloc(count * sizeof(int));
+  if (keys == NULL || probes == NULL) {
+    return EXIT_FAILURE;
+  }
+  for (int i = 0; i < count; i++) {
+    keys[i] = i * 2; // even keys, odd probes miss
+    probes[i] = i * 2 + (i & 1);
+  }
+  shuffle(keys, count);
+  shuffle(probes, count);
+
+  // values are NULL so both trees measure only the structure itself
+  bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+  bst_node_content_t *found = NULL;
+  long checksum = 0;
+  double start;
+
+  printf("%d random keys\n\n", count);
+
+  bpt_node_t *bpt;
+  bpt_init(&bpt);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    bpt_insert(&bpt, keys[i], empty);
+  }
+  report("bpt", "insert", start, count);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    checksum += bpt_search(bpt, probes[i], &found);
+  }
+  report("bpt", "search", start, count);
+  start = now_ns();
+  bpt_inorder(bpt, count_visit, &checksum);
+  report("bpt", "inorder", start, count);
+  start = now_ns();
+  for (int i = 0; i < count / 2; i++) {
+    bpt_delete(&bpt, keys[i]);
+  }
+  report("bpt", "delete", start, count / 2);
+  start = now_ns();
+  bpt_dispose(&bpt);
+  report("bpt", "dispose", start, count - count / 2);
+
+  printf("\n");
+
+  bst_node_t *bst;
+  bst_init(&bst);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    bst_insert(&bst, keys[i], empty);
+  }
+  report("bst", "insert", start, count);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    checksum += bst_search(bst, probes[i], &found);
+  }
+  report("bst", "search", start, count);
+  bst_items_t items;
+  bst_items_init(&items);
+  start = now_ns();
+  bst_inorder(bst, &items);
+  for (int i = 0; i < items.size; i++) {
+    checksum += items.nodes[i]->key;
+  }
+  report("bst", "inorder", start, count);
+  free(items.nodes);
+  start = now_ns();
+  for (int i = 0; i < count / 2; i++) {
+    bst_delete(&bst, keys[i]);
+  }
+  report("bst", "delete", start, count / 2);
+  start = now_ns();
+  bst_dispose(&bst);
+  report("bst", "dispose", start, count - count / 2);
+
+  printf("\nchecksum %ld\n", checksum);
+  free(keys);
+  free(probes);
+  return EXIT_SUCCESS;
+}
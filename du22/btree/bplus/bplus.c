@@ -0,0 +1,456 @@
+/*
+ * B+ strom se širokými uzly
+ *
+ * Klíče uzlu leží v jednom souvislém poli, vyhledání v uzlu porovná celé pole
+ * najednou pomocí SIMD instrukcí (SSE2/AVX2, jinak skalárně). Hodnoty jsou
+ * uložené jen v listech, které jsou zřetězené pro sekvenční inorder průchod.
+ */
+
+#include "bplus.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Doplní nepoužité pozice klíčů hodnotou INT_MAX, aby je SIMD porovnání
+ * nikdy nezapočítalo mezi menší klíče.
+ */
+static void bpt_pad(bpt_node_t *node)
+{
+  for (int i = node->count; i < BPT_ORDER; i++) {
+    node->keys[i] = INT_MAX;
+  }
+}
+
+/*
+ * Alokace prázdného uzlu zarovnaného na cache line.
+ */
+static bpt_node_t *bpt_new_node(bool leaf)
+{
+  size_t size = (sizeof(bpt_node_t) + 63) / 64 * 64;
+  bpt_node_t *node = aligned_alloc(64, size);
+  if (node == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  node->count = 0;
+  node->leaf = leaf;
+  node->next = NULL;
+  bpt_pad(node);
+  return node;
+}
+
+/*
+ * Počet klíčů uzlu, které jsou menší než key (pozice prvního klíče >= key).
+ *
+ * Funkce porovná vždy všech BPT_ORDER pozic bez větvení, nepoužité pozice
+ * obsahují INT_MAX a výsledek proto neovlivní.
+ */
+int bpt_node_lower_bound(const bpt_node_t *node, int key)
+{
+#if defined(__AVX2__)
+  __m256i needle = _mm256_set1_epi32(key);
+  __m256i acc = _mm256_setzero_si256();
+  for (int i = 0; i < BPT_ORDER; i += 8) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)&node->keys[i]);
+    acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(needle, block)); // -1 where keys[i] < key
+  }
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+#elif defined(__SSE2__)
+  __m128i needle = _mm_set1_epi32(key);
+  __m128i acc = _mm_setzero_si128();
+  for (int i = 0; i < BPT_ORDER; i += 4) {
+    __m128i block = _mm_loadu_si128((const __m128i *)&node->keys[i]);
+    acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(block, needle)); // -1 where keys[i] < key
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(acc);
+#else
+  int result = 0;
+  for (int i = 0; i < BPT_ORDER; i++) {
+    result += node->keys[i] < key;
+  }
+  return result;
+#endif
+}
+
+/*
+ * Index potomka vnitřního uzlu, ve kterém leží klíč key.
+ * Potomek i obsahuje klíče menší než keys[i], klíč rovný oddělovači patří doprava.
+ */
+static int bpt_child_index(const bpt_node_t *node, int key)
+{
+  int index = bpt_node_lower_bound(node, key);
+  if (index < node->count && node->keys[index] == key) {
+    index++;
+  }
+  return index;
+}
+
+/*
+ * Inicializace stromu.
+ */
+void bpt_init(bpt_node_t **tree)
+{
+  *tree = NULL;
+}
+
+/*
+ * Vyhledání klíče ve stromu.
+ *
+ * V případě úspěchu vrátí funkce true a do value zapíše ukazatel na obsah
+ * v listu. Jinak vrátí false a value zůstává nezměněná.
+ */
+bool bpt_search(bpt_node_t *tree, int key, bst_node_content_t **value)
+{
+  if (tree == NULL) {
+    return false;
+  }
+
+  bpt_node_t *node = tree;
+  while (!node->leaf) { // descend to the leaf
+    node = node->children[bpt_child_index(node, key)];
+  }
+
+  int index = bpt_node_lower_bound(node, key);
+  if (index < node->count && node->keys[index] == key) {
+    *value = &node->contents[index];
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Vložení dvojice klíč/hodnota.
+ *
+ * Pokud klíč už existuje, jeho hodnota je nahrazena (stará hodnota je
+ * uvolněna). Přeplněné uzly se dělí od listu směrem ke kořeni.
+ */
+void bpt_insert(bpt_node_t **tree, int key, bst_node_content_t value)
+{
+  if (*tree == NULL) { // empty tree -> the root is a leaf
+    *tree = bpt_new_node(true);
+  }
+
+  bpt_node_t *path[BPT_MAX_HEIGHT];
+  int slots[BPT_MAX_HEIGHT];
+  int depth = 0;
+
+  bpt_node_t *node = *tree;
+  while (!node->leaf) { // remember the path for splitting
+    int slot = bpt_child_index(node, key);
+    path[depth] = node;
+    slots[depth] = slot;
+    depth++;
+    node = node->children[slot];
+  }
+
+  int index = bpt_node_lower_bound(node, key);
+  if (index < node->count && node->keys[index] == key) { // replace the value
+    if (node->contents[index].value != NULL) {
+      free(node->contents[index].value);
+    }
+    node->contents[index] = value;
+    return;
+  }
+
+  if (node->count < BPT_ORDER) { // room in the leaf
+    memmove(&node->keys[index + 1], &node->keys[index],
+            (node->count - index) * sizeof(int));
+    memmove(&node->contents[index + 1], &node->contents[index],
+            (node->count - index) * sizeof(bst_node_content_t));
+    node->keys[index] = key;
+    node->contents[index] = value;
+    node->count++;
+    return;
+  }
+
+  // split the full leaf, the new entry goes into a temporary sequence first
+  int tmp_keys[BPT_ORDER + 1];
+  bst_node_content_t tmp_contents[BPT_ORDER + 1];
+  memcpy(tmp_keys, node->keys, index * sizeof(int));
+  memcpy(tmp_contents, node->contents, index * sizeof(bst_node_content_t));
+  tmp_keys[index] = key;
+  tmp_contents[index] = value;
+  memcpy(&tmp_keys[index + 1], &node->keys[index],
+         (BPT_ORDER - index) * sizeof(int));
+  memcpy(&tmp_contents[index + 1], &node->contents[index],
+         (BPT_ORDER - index) * sizeof(bst_node_content_t));
+
+  int left_count = (BPT_ORDER + 1) / 2;
+  bpt_node_t *right = bpt_new_node(true);
+  node->count = left_count;
+  memcpy(node->keys, tmp_keys, left_count * sizeof(int));
+  memcpy(node->contents, tmp_contents, left_count * sizeof(bst_node_content_t));
+  bpt_pad(node);
+  right->count = BPT_ORDER + 1 - left_count;
+  memcpy(right->keys, &tmp_keys[left_count], right->count * sizeof(int));
+  memcpy(right->contents, &tmp_contents[left_count],
+         right->count * sizeof(bst_node_content_t));
+  right->next = node->next;
+  node->next = right;
+
+  int separator = right->keys[0];
+  bpt_node_t *new_child = right;
+
+  // propagate the split towards the root
+  while (depth > 0) {
+    depth--;
+    bpt_node_t *parent = path[depth];
+    int slot = slots[depth];
+
+    if (parent->count < BPT_ORDER) { // room in the parent
+      memmove(&parent->keys[slot + 1], &parent->keys[slot],
+              (parent->count - slot) * sizeof(int));
+      memmove(&parent->children[slot + 2], &parent->children[slot + 1],
+              (parent->count - slot) * sizeof(bpt_node_t *));
+      parent->keys[slot] = separator;
+      parent->children[slot + 1] = new_child;
+      parent->count++;
+      return;
+    }
+
+    // split the full internal node, the middle key moves up
+    int tmp_sep[BPT_ORDER + 1];
+    bpt_node_t *tmp_children[BPT_ORDER + 2];
+    memcpy(tmp_sep, parent->keys, slot * sizeof(int));
+    tmp_sep[slot] = separator;
+    memcpy(&tmp_sep[slot + 1], &parent->keys[slot],
+           (BPT_ORDER - slot) * sizeof(int));
+    memcpy(tmp_children, parent->children, (slot + 1) * sizeof(bpt_node_t *));
+    tmp_children[slot + 1] = new_child;
+    memcpy(&tmp_children[slot + 2], &parent->children[slot + 1],
+           (BPT_ORDER - slot) * sizeof(bpt_node_t *));
+
+    int keep = (BPT_ORDER + 1) / 2;
+    bpt_node_t *sibling = bpt_new_node(false);
+    parent->count = keep;
+    memcpy(parent->keys, tmp_sep, keep * sizeof(int));
+    memcpy(parent->children, tmp_children, (keep + 1) * sizeof(bpt_node_t *));
+    bpt_pad(parent);
+    sibling->count = BPT_ORDER - keep;
+    memcpy(sibling->keys, &tmp_sep[keep + 1], sibling->count * sizeof(int));
+    memcpy(sibling->children, &tmp_children[keep + 1],
+           (sibling->count + 1) * sizeof(bpt_node_t *));
+
+    separator = tmp_sep[keep];
+    new_child = sibling;
+  }
+
+  // the root was split -> the tree grows by one level
+  bpt_node_t *root = bpt_new_node(false);
+  root->count = 1;
+  root->keys[0] = separator;
+  root->children[0] = *tree;
+  root->children[1] = new_child;
+  *tree = root;
+}
+
+/*
+ * Pomocná funkce, která odstraní klíč keys[index] a potomka children[index + 1]
+ * z vnitřního uzlu.
+ */
+static void bpt_remove_separator(bpt_node_t *node, int index)
+{
+  memmove(&node->keys[index], &node->keys[index + 1],
+          (node->count - index - 1) * sizeof(int));
+  memmove(&node->children[index + 1], &node->children[index + 2],
+          (node->count - index - 1) * sizeof(bpt_node_t *));
+  node->count--;
+  bpt_pad(node);
+}
+
+/*
+ * Pomocná funkce, která doplní podtečený uzel node (potomek parent na pozici
+ * slot) o jeden klíč ze sourozence nebo ho se sourozencem sloučí.
+ *
+ * Vrací true, pokud došlo ke sloučení a rodič tím přišel o jeden klíč.
+ */
+static bool bpt_rebalance(bpt_node_t *parent, int slot, bpt_node_t *node)
+{
+  bpt_node_t *left = slot > 0 ? parent->children[slot - 1] : NULL;
+  bpt_node_t *right = slot < parent->count ? parent->children[slot + 1] : NULL;
+
+  if (left != NULL && left->count > BPT_MIN_KEYS) { // borrow from the left sibling
+    memmove(&node->keys[1], &node->keys[0], node->count * sizeof(int));
+    if (node->leaf) {
+      memmove(&node->contents[1], &node->contents[0],
+              node->count * sizeof(bst_node_content_t));
+      node->keys[0] = left->keys[left->count - 1];
+      node->contents[0] = left->contents[left->count - 1];
+      parent->keys[slot - 1] = node->keys[0];
+    }
+    else {
+      memmove(&node->children[1], &node->children[0],
+              (node->count + 1) * sizeof(bpt_node_t *));
+      node->keys[0] = parent->keys[slot - 1];
+      node->children[0] = left->children[left->count];
+      parent->keys[slot - 1] = left->keys[left->count - 1];
+    }
+    node->count++;
+    left->count--;
+    bpt_pad(left);
+    return false;
+  }
+
+  if (right != NULL && right->count > BPT_MIN_KEYS) { // borrow from the right sibling
+    if (node->leaf) {
+      node->keys[node->count] = right->keys[0];
+      node->contents[node->count] = right->contents[0];
+      memmove(&right->contents[0], &right->contents[1],
+              (right->count - 1) * sizeof(bst_node_content_t));
+    }
+    else {
+      node->keys[node->count] = parent->keys[slot];
+      node->children[node->count + 1] = right->children[0];
+      memmove(&right->children[0], &right->children[1],
+              right->count * sizeof(bpt_node_t *));
+    }
+    parent->keys[slot] = node->leaf ? right->keys[1] : right->keys[0];
+    memmove(&right->keys[0], &right->keys[1], (right->count - 1) * sizeof(int));
+    node->count++;
+    right->count--;
+    bpt_pad(right);
+    return false;
+  }
+
+  // merge with a sibling, the right one of the pair is freed
+  int separator_index = left != NULL ? slot - 1 : slot;
+  bpt_node_t *target = left != NULL ? left : node;
+  bpt_node_t *source = left != NULL ? node : right;
+
+  if (target->leaf) {
+    memcpy(&target->keys[target->count], source->keys, source->count * sizeof(int));
+    memcpy(&target->contents[target->count], source->contents,
+           source->count * sizeof(bst_node_content_t));
+    target->count += source->count;
+    target->next = source->next;
+  }
+  else {
+    target->keys[target->count] = parent->keys[separator_index];
+    memcpy(&target->keys[target->count + 1], source->keys,
+           source->count * sizeof(int));
+    memcpy(&target->children[target->count + 1], source->children,
+           (source->count + 1) * sizeof(bpt_node_t *));
+    target->count += source->count + 1;
+  }
+  free(source);
+  bpt_remove_separator(parent, separator_index);
+  return true;
+}
+
+/*
+ * Odstranění klíče ze stromu.
+ *
+ * Pokud klíč neexistuje, funkce nic nedělá. Podtečené uzly si půjčí klíč od
+ * sourozence nebo se s ním sloučí, prázdný kořen je odstraněn.
+ */
+void bpt_delete(bpt_node_t **tree, int key)
+{
+  if (*tree == NULL) {
+    return;
+  }
+
+  bpt_node_t *path[BPT_MAX_HEIGHT];
+  int slots[BPT_MAX_HEIGHT];
+  int depth = 0;
+
+  bpt_node_t *node = *tree;
+  while (!node->leaf) {
+    int slot = bpt_child_index(node, key);
+    path[depth] = node;
+    slots[depth] = slot;
+    depth++;
+    node = node->children[slot];
+  }
+
+  int index = bpt_node_lower_bound(node, key);
+  if (index >= node->count || node->keys[index] != key) {
+    return; // key not found
+  }
+
+  // remove the entry from the leaf
+  if (node->contents[index].value != NULL) {
+    free(node->contents[index].value);
+  }
+  memmove(&node->keys[index], &node->keys[index + 1],
+          (node->count - index - 1) * sizeof(int));
+  memmove(&node->contents[index], &node->contents[index + 1],
+          (node->count - index - 1) * sizeof(bst_node_content_t));
+  node->count--;
+  bpt_pad(node);
+
+  // fix underflows on the way up
+  while (depth > 0 && node->count < BPT_MIN_KEYS) {
+    depth--;
+    if (!bpt_rebalance(path[depth], slots[depth], node)) {
+      break;
+    }
+    node = path[depth];
+  }
+
+  bpt_node_t *root = *tree;
+  if (root->count == 0) { // shrink the tree
+    *tree = root->leaf ? NULL : root->children[0];
+    free(root);
+  }
+}
+
+/*
+ * Zrušení celého stromu včetně hodnot v listech.
+ */
+void bpt_dispose(bpt_node_t **tree)
+{
+  bpt_node_t *node = *tree;
+  if (node == NULL) {
+    return;
+  }
+
+  if (node->leaf) {
+    for (int i = 0; i < node->count; i++) {
+      if (node->contents[i].value != NULL) {
+        free(node->contents[i].value);
+      }
+    }
+  }
+  else {
+    // the height is logarithmic, recursion depth stays small
+    for (int i = 0; i <= node->count; i++) {
+      bpt_dispose(&node->children[i]);
+    }
+  }
+  free(node);
+  *tree = NULL;
+}
+
+/*
+ * Inorder průchod stromem.
+ *
+ * Najde nejlevější list a dál čte zřetězené listy, funkci visit zavolá pro
+ * každou dvojici klíč/hodnota ve vzestupném pořadí klíčů.
+ */
+void bpt_inorder(bpt_node_t *tree, bpt_visit_t visit, void *ctx)
+{
+  if (tree == NULL) {
+    return;
+  }
+
+  bpt_node_t *node = tree;
+  while (!node->leaf) {
+    node = node->children[0];
+  }
+
+  for (; node != NULL; node = node->next) { // sequential scan over the leaves
+    for (int i = 0; i < node->count; i++) {
+      visit(node->keys[i], &node->contents[i], ctx);
+    }
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ * Hlavičkový soubor pro B+ strom se širokými uzly.
+ *
+ * Uzel obsahuje až BPT_ORDER seřazených klíčů, takže jedno vyhledání v uzlu
+ * nahradí několik úrovní binárního stromu. Listy jsou zřetězené, inorder
+ * průchod je proto sekvenční čtení listů.
+ */
+
+#ifndef IAL_BTREE_BPLUS_H
+#define IAL_BTREE_BPLUS_H
+
+#include "../btree.h"
+#include <stdbool.h>
+
+// Maximální počet klíčů v uzlu (32 klíčů typu int = dvě cache line)
+#define BPT_ORDER 32
+
+// Minimální počet klíčů v uzlu, který není kořenem
+#define BPT_MIN_KEYS (BPT_ORDER / 2)
+
+// Maximální výška stromu (pro BPT_ORDER 32 stačí i pro 2^32 klíčů)
+#define BPT_MAX_HEIGHT 16
+
+// Uzel B+ stromu
+typedef struct bpt_node {
+  int keys[BPT_ORDER];         // seřazené klíče, nepoužité pozice jsou INT_MAX
+  int count;                   // počet platných klíčů
+  bool leaf;                   // true pro listový uzel
+  struct bpt_node *next;       // následující list (jen v listech)
+  union {
+    struct bpt_node *children[BPT_ORDER + 1]; // potomci vnitřního uzlu
+    bst_node_content_t contents[BPT_ORDER];   // hodnoty listu
+  };
+} bpt_node_t;
+
+// Funkce volaná pro každou dvojici klíč/hodnota při průchodu
+typedef void (*bpt_visit_t)(int key, bst_node_content_t *content, void *ctx);
+
+void bpt_init(bpt_node_t **tree);
+bool bpt_search(bpt_node_t *tree, int key, bst_node_content_t **value);
+void bpt_insert(bpt_node_t **tree, int key, bst_node_content_t value);
+void bpt_delete(bpt_node_t **tree, int key);
+void bpt_dispose(bpt_node_t **tree);
+void bpt_inorder(bpt_node_t *tree, bpt_visit_t visit, void *ctx);
+
+int bpt_node_lower_bound(const bpt_node_t *node, int key);
+
+#endif
@@ -0,0 +1,201 @@
+#include "bplus.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  void NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    bpt_node_t *test_tree;                                                     \
+    bpt_init(&test_tree);
+
+#define ENDTEST                                                                \
+  printf("\n");                                                                \
+  bpt_dispose(&test_tree);                                                     \
+  }
+
+const int many_count = 1000;
+
+bst_node_content_t create_integer_content(int value)
+{
+  bst_node_content_t result = {
+    .type = INTEGER,
+    .value = malloc(sizeof(int))
+  };
+  *((int*)(result.value)) = value;
+  return result;
+}
+
+/*
+ * Ověří invarianty stromu (seřazené klíče, rozsahy podstromů, zaplnění uzlů,
+ * stejná hloubka listů) a vrátí hloubku listů nebo -1 při porušení.
+ */
+int bpt_check(bpt_node_t *node, long low, long high, bool root)
+{
+  if (!root && node->count < BPT_MIN_KEYS) {
+    return -1;
+  }
+  for (int i = 0; i < BPT_ORDER; i++) {
+    if (i < node->count && (node->keys[i] < low || node->keys[i] >= high)) {
+      return -1;
+    }
+    if (i > 0 && i < node->count && node->keys[i - 1] >= node->keys[i]) {
+      return -1;
+    }
+    if (i >= node->count && node->keys[i] != INT_MAX) {
+      return -1;
+    }
+  }
+  if (node->leaf) {
+    return 0;
+  }
+  int depth = -1;
+  for (int i = 0; i <= node->count; i++) {
+    long child_low = i == 0 ? low : node->keys[i - 1];
+    long child_high = i == node->count ? high : node->keys[i];
+    int child_depth = bpt_check(node->children[i], child_low, child_high, false);
+    if (child_depth < 0 || (depth >= 0 && child_depth != depth)) {
+      return -1;
+    }
+    depth = child_depth;
+  }
+  return depth + 1;
+}
+
+void bpt_print_check(bpt_node_t *tree)
+{
+  if (tree == NULL) {
+    printf("Tree is empty\n");
+    return;
+  }
+  int height = bpt_check(tree, INT_MIN, (long)INT_MAX + 1, true);
+  if (height < 0) {
+    printf("Invariants violated\n");
+  }
+  else {
+    printf("Invariants hold, height %d\n", height + 1);
+  }
+}
+
+void print_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  printf("[%d,%d]", key, *(int *)content->value);
+}
+
+void count_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  int *state = ctx; // state[0] = count, state[1] = previous key, state[2] = order ok
+  if (state[0] > 0 && key <= state[1]) {
+    state[2] = 0;
+  }
+  state[0]++;
+  state[1] = key;
+}
+
+void print_scan(bpt_node_t *tree)
+{
+  int state[3] = {0, 0, 1};
+  bpt_inorder(tree, count_visit, state);
+  printf("Scanned %d keys, %s\n", state[0], state[2] ? "ascending" : "NOT ascending");
+}
+
+void print_search(bpt_node_t *tree, int key)
+{
+  bst_node_content_t *result = NULL;
+  if (bpt_search(tree, key, &result)) {
+    printf("Search %d: %d\n", key, *(int *)result->value);
+  }
+  else {
+    printf("Search %d: not found\n", key);
+  }
+}
+
+void insert_shuffled(bpt_node_t **tree, int count)
+{
+  // 7919 is prime, multiplying by it permutes 0..count-1 unless count is its multiple
+  for (int i = 0; i < count; i++) {
+    int key = (i * 7919) % count;
+    bpt_insert(tree, key, create_integer_content(key * 10));
+  }
+}
+
+TEST(test_bpt_empty, "Search and delete in an empty tree")
+print_search(test_tree, 1);
+bpt_delete(&test_tree, 1);
+bpt_print_check(test_tree);
+ENDTEST
+
+TEST(test_bpt_insert_leaf, "Insert a few keys into the root leaf")
+bpt_insert(&test_tree, 5, create_integer_content(50));
+bpt_insert(&test_tree, 1, create_integer_content(10));
+bpt_insert(&test_tree, 3, create_integer_content(30));
+bpt_inorder(test_tree, print_visit, NULL);
+printf("\n");
+print_search(test_tree, 3);
+print_search(test_tree, 4);
+bpt_print_check(test_tree);
+ENDTEST
+
+TEST(test_bpt_update, "Update an existing key")
+bpt_insert(&test_tree, 7, create_integer_content(1));
+bpt_insert(&test_tree, 7, create_integer_content(2));
+bpt_inorder(test_tree, print_visit, NULL);
+printf("\n");
+ENDTEST
+
+TEST(test_bpt_insert_many, "Insert many keys to force splits")
+insert_shuffled(&test_tree, many_count);
+bpt_print_check(test_tree);
+print_scan(test_tree);
+print_search(test_tree, 0);
+print_search(test_tree, 517);
+print_search(test_tree, many_count - 1);
+print_search(test_tree, many_count);
+ENDTEST
+
+TEST(test_bpt_insert_sorted, "Insert sorted keys")
+for (int i = 0; i < many_count; i++) {
+  bpt_insert(&test_tree, i, create_integer_content(i));
+}
+bpt_print_check(test_tree);
+print_scan(test_tree);
+ENDTEST
+
+TEST(test_bpt_delete_some, "Delete every third key")
+insert_shuffled(&test_tree, many_count);
+for (int i = 0; i < many_count; i += 3) {
+  bpt_delete(&test_tree, i);
+}
+bpt_delete(&test_tree, -5);
+bpt_print_check(test_tree);
+print_scan(test_tree);
+print_search(test_tree, 3);
+print_search(test_tree, 4);
+ENDTEST
+
+TEST(test_bpt_delete_all, "Delete all keys to force merges")
+insert_shuffled(&test_tree, many_count);
+for (int i = many_count - 1; i >= 0; i -= 2) {
+  bpt_delete(&test_tree, i);
+}
+bpt_print_check(test_tree);
+for (int i = 0; i < many_count; i += 2) {
+  bpt_delete(&test_tree, i);
+}
+bpt_print_check(test_tree);
+ENDTEST
+
+int main(int argc, char *argv[])
+{
+  printf("B+ Tree - testing script\n");
+  printf("------------------------\n");
+  printf("\n");
+
+  test_bpt_empty();
+  test_bpt_insert_leaf();
+  test_bpt_update();
+  test_bpt_insert_many();
+  test_bpt_insert_sorted();
+  test_bpt_delete_some();
+  test_bpt_delete_all();
+}
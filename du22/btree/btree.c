@@ -2,6 +2,7 @@
 #include "character.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*
  * Pomocná funkce pro výpis uzlu stromu.
@@ -31,6 +32,7 @@ void bst_print_node_content(bst_node_content_t *content)
 
   case CHARACTER_T:
     print_character((character_t*)content->value);
+    break;
 
   default:
     printf("Unknown");
@@ -46,9 +48,737 @@ void bst_add_node_to_items(bst_node_t *node, bst_items_t *items)
 {
   if (items->capacity < items->size + 1)
   {
-    items->capacity = items->capacity * 2 + 8;
-    items->nodes = realloc(items->nodes, items->capacity * (sizeof(bst_node_t *)));
+    bst_items_reserve(items, items->capacity * 2 + 8);
   }
   items->nodes[items->size] = node;
   items->size++;
-}
\ No newline at end of file
+}
+
+/*
+ * Inicializace prázdného pole na haldě, uvolňuje se pomocí free(items->nodes).
+ */
+void bst_items_init(bst_items_t *items)
+{
+  bst_items_init_arena(items, NULL, 0);
+}
+
+/*
+ * Zajistí kapacitu pole alespoň capacity uzlů. Uložené uzly zůstávají.
+ * Pole z areny se zvětší novým úsekem téže areny.
+ */
+void bst_items_reserve(bst_items_t *items, int capacity)
+{
+  if (capacity <= items->capacity) {
+    return;
+  }
+  bst_node_t **nodes;
+  if (items->arena != NULL) {
+    nodes = bst_arena_alloc(items->arena, capacity * sizeof(bst_node_t *));
+    if (items->size > 0) {
+      memcpy(nodes, items->nodes, items->size * sizeof(bst_node_t *));
+    }
+  }
+  else {
+    nodes = realloc(items->nodes, capacity * sizeof(bst_node_t *));
+    if (nodes == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+  }
+  items->nodes = nodes;
+  items->capacity = capacity;
+}
+
+/*
+ * Vyprázdnění pole bez uvolnění paměti, pro opakované použití v dalším
+ * průchodu.
+ */
+void bst_items_clear(bst_items_t *items)
+{
+  items->size = 0;
+}
+
+/*
+ * Inicializace prázdného pole, jehož paměť se bere z areny. Pole se
+ * neuvolňuje samostatně, ale spolu s arenou (bst_arena_reset nebo
+ * bst_arena_dispose), po kterých se už nesmí používat.
+ */
+void bst_items_init_arena(bst_items_t *items, bst_arena_t *arena, int capacity)
+{
+  items->nodes = NULL;
+  items->capacity = 0;
+  items->size = 0;
+  items->arena = arena;
+  bst_items_reserve(items, capacity);
+}
+
+static bst_arena_block_t *bst_arena_block(bst_arena_block_t *next, size_t capacity)
+{
+  bst_arena_block_t *block = malloc(sizeof(bst_arena_block_t) + capacity);
+  if (block == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  block->next = next;
+  block->used = 0;
+  block->capacity = capacity;
+  return block;
+}
+
+/*
+ * Inicializace areny s prvním blokem o velikosti capacity bajtů.
+ */
+void bst_arena_init(bst_arena_t *arena, size_t capacity)
+{
+  capacity = capacity > 0 ? capacity : 4096;
+  arena->block = bst_arena_block(NULL, capacity);
+  arena->total = capacity;
+}
+
+/*
+ * Přidělení size bajtů z areny. Nevejde-li se požadavek do aktuálního bloku,
+ * přidá se blok alespoň dvakrát větší než všechny dosavadní dohromady.
+ */
+void *bst_arena_alloc(bst_arena_t *arena, size_t size)
+{
+  size_t align = sizeof(max_align_t);
+  size = (size + align - 1) / align * align;
+  bst_arena_block_t *block = arena->block;
+  if (block->capacity - block->used < size) {
+    size_t capacity = 2 * arena->total > size ? 2 * arena->total : size;
+    block = arena->block = bst_arena_block(block, capacity);
+    arena->total += capacity;
+  }
+  void *memory = (char *)block->data + block->used;
+  block->used += size;
+  return memory;
+}
+
+/*
+ * Uvolnění všeho, co bylo z areny přiděleno. Pokud bylo potřeba víc bloků,
+ * nahradí je jeden blok o jejich celkové velikosti, takže se stejně velká
+ * další dávka vejde bez alokace.
+ */
+void bst_arena_reset(bst_arena_t *arena)
+{
+  if (arena->block->next == NULL) {
+    arena->block->used = 0;
+    return;
+  }
+  size_t total = arena->total;
+  bst_arena_dispose(arena);
+  arena->block = bst_arena_block(NULL, total);
+  arena->total = total;
+}
+
+/*
+ * Uvolnění areny.
+ */
+void bst_arena_dispose(bst_arena_t *arena)
+{
+  while (arena->block != NULL) {
+    bst_arena_block_t *next = arena->block->next;
+    free(arena->block);
+    arena->block = next;
+  }
+  arena->total = 0;
+}
+
+/*
+ * Pomocná funkce typu bst_visit_t, která uloží uzel do struktury items.
+ */
+void bst_items_visit(bst_node_t *node, void *items)
+{
+  bst_add_node_to_items(node, items);
+}
+
+/*
+ * Preorder průchod stromem bez zásobníku a bez rekurze (Morrisův průchod).
+ *
+ * Po dobu průchodu se do prázdných pravých ukazatelů dočasně ukládají odkazy
+ * zpět na následníka, po dokončení je strom ve stejném stavu jako předtím.
+ * Průchod proto potřebuje jen O(1) paměti navíc, ale stejný strom nesmí
+ * současně procházet jiné vlákno a funkce visit nesmí strom měnit ani číst
+ * pravé ukazatele uzlů.
+ */
+void bst_morris_preorder(bst_node_t *tree, bst_visit_t visit, void *ctx)
+{
+  bst_node_t *active_node = tree;
+  while (active_node != NULL) {
+    if (active_node->left == NULL) {
+      visit(active_node, ctx);
+      active_node = active_node->right; // real child or thread back up
+      continue;
+    }
+
+    // find the inorder predecessor in the left subtree
+    bst_node_t *predecessor = active_node->left;
+    while (predecessor->right != NULL && predecessor->right != active_node) {
+      predecessor = predecessor->right;
+    }
+
+    if (predecessor->right == NULL) { // first visit -> thread and go left
+      visit(active_node, ctx);
+      predecessor->right = active_node;
+      active_node = active_node->left;
+    }
+    else { // left subtree done -> remove the thread
+      predecessor->right = NULL;
+      active_node = active_node->right;
+    }
+  }
+}
+
+/*
+ * Inorder průchod stromem bez zásobníku a bez rekurze (Morrisův průchod).
+ *
+ * Platí stejná omezení jako pro bst_morris_preorder.
+ */
+void bst_morris_inorder(bst_node_t *tree, bst_visit_t visit, void *ctx)
+{
+  bst_node_t *active_node = tree;
+  while (active_node != NULL) {
+    if (active_node->left == NULL) {
+      visit(active_node, ctx);
+      active_node = active_node->right; // real child or thread back up
+      continue;
+    }
+
+    // find the inorder predecessor in the left subtree
+    bst_node_t *predecessor = active_node->left;
+    while (predecessor->right != NULL && predecessor->right != active_node) {
+      predecessor = predecessor->right;
+    }
+
+    if (predecessor->right == NULL) { // first visit -> thread and go left
+      predecessor->right = active_node;
+      active_node = active_node->left;
+    }
+    else { // left subtree done -> remove the thread and visit
+      predecessor->right = NULL;
+      visit(active_node, ctx);
+      active_node = active_node->right;
+    }
+  }
+}
+
+/*
+ * Pomocná funkce pro vložení uzlu do zásobníku kurzoru.
+ *
+ * Prvních BST_CURSOR_INLINE_SIZE uzlů se ukládá přímo do kurzoru, pak se
+ * zásobník přesune na haldu a jeho kapacita se zdvojnásobuje.
+ */
+static void bst_cursor_push(bst_cursor_t *cursor, bst_node_t *node)
+{
+  if (cursor->size == cursor->capacity) {
+    int capacity = cursor->capacity * 2;
+    bst_node_t **stack;
+    if (cursor->stack == cursor->inline_stack) {
+      stack = malloc(capacity * sizeof(bst_node_t *));
+      if (stack != NULL) {
+        memcpy(stack, cursor->inline_stack, cursor->size * sizeof(bst_node_t *));
+      }
+    }
+    else {
+      stack = realloc(cursor->stack, capacity * sizeof(bst_node_t *));
+    }
+    if (stack == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    cursor->stack = stack;
+    cursor->capacity = capacity;
+  }
+  cursor->stack[cursor->size++] = node;
+}
+
+/*
+ * Pomocná funkce, která vloží do zásobníku kurzoru levou větev podstromu.
+ */
+static void bst_cursor_push_leftmost(bst_cursor_t *cursor, bst_node_t *tree)
+{
+  while (tree != NULL) {
+    bst_cursor_push(cursor, tree);
+    tree = tree->left;
+  }
+}
+
+/*
+ * Inicializace kurzoru pro průchod stromem v zadaném pořadí.
+ *
+ * Kurzor nic nematerializuje, uzly vrací postupně funkce bst_cursor_next.
+ * Strom se během průchodu nesmí měnit. Po použití je nutné zavolat
+ * bst_cursor_dispose.
+ */
+void bst_cursor_init(bst_cursor_t *cursor, bst_node_t *tree, bst_order_t order)
+{
+  cursor->root = tree;
+  cursor->order = order;
+  cursor->stack = cursor->inline_stack;
+  cursor->capacity = BST_CURSOR_INLINE_SIZE;
+  cursor->size = 0;
+  cursor->descend = NULL;
+  cursor->last = NULL;
+
+  switch (order)
+  {
+  case BST_PREORDER:
+    if (tree != NULL) {
+      bst_cursor_push(cursor, tree);
+    }
+    break;
+
+  case BST_INORDER:
+    bst_cursor_push_leftmost(cursor, tree);
+    break;
+
+  case BST_POSTORDER:
+    cursor->descend = tree;
+    break;
+  }
+}
+
+/*
+ * Vrátí další uzel průchodu, nebo NULL, pokud průchod skončil.
+ */
+bst_node_t *bst_cursor_next(bst_cursor_t *cursor)
+{
+  bst_node_t *node;
+
+  switch (cursor->order)
+  {
+  case BST_PREORDER:
+    if (cursor->size == 0) {
+      return NULL;
+    }
+    node = cursor->stack[--cursor->size];
+    // right goes first so the left subtree is on top
+    if (node->right != NULL) {
+      bst_cursor_push(cursor, node->right);
+    }
+    if (node->left != NULL) {
+      bst_cursor_push(cursor, node->left);
+    }
+    return node;
+
+  case BST_INORDER:
+    if (cursor->size == 0) {
+      return NULL;
+    }
+    node = cursor->stack[--cursor->size];
+    bst_cursor_push_leftmost(cursor, node->right);
+    return node;
+
+  case BST_POSTORDER:
+    while (true) {
+      if (cursor->descend != NULL) { // go down the left branch
+        bst_cursor_push(cursor, cursor->descend);
+        cursor->descend = cursor->descend->left;
+        continue;
+      }
+      if (cursor->size == 0) {
+        return NULL;
+      }
+      node = cursor->stack[cursor->size - 1];
+      if (node->right != NULL && cursor->last != node->right) { // right subtree pending
+        cursor->descend = node->right;
+        continue;
+      }
+      cursor->size--;
+      cursor->last = node;
+      return node;
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Přesun kurzoru v rámci jeho průchodu.
+ *
+ * Při inorder průchodu bude dalším vráceným uzlem první uzel s klíčem
+ * větším nebo rovným key. Při preorder a postorder průchodu bude dalším
+ * uzlem uzel s klíčem key, pokud ve stromu není, průchod končí.
+ * Funkce vrací true, pokud strom obsahuje uzel s klíčem key.
+ */
+bool bst_cursor_seek(bst_cursor_t *cursor, int key)
+{
+  cursor->size = 0;
+  cursor->descend = NULL;
+  cursor->last = NULL;
+  bst_node_t *node = cursor->root;
+
+  switch (cursor->order)
+  {
+  case BST_PREORDER:
+    // pending right subtrees of the ancestors where the search went left
+    while (node != NULL && node->key != key) {
+      if (key < node->key) {
+        if (node->right != NULL) {
+          bst_cursor_push(cursor, node->right);
+        }
+        node = node->left;
+      }
+      else {
+        node = node->right;
+      }
+    }
+    if (node == NULL) {
+      cursor->size = 0;
+      return false;
+    }
+    bst_cursor_push(cursor, node);
+    return true;
+
+  case BST_INORDER:
+    // ancestors where the search went left are the pending successors
+    while (node != NULL) {
+      if (key <= node->key) {
+        bst_cursor_push(cursor, node);
+        if (key == node->key) {
+          return true;
+        }
+        node = node->left;
+      }
+      else {
+        node = node->right;
+      }
+    }
+    return false;
+
+  case BST_POSTORDER:
+    // all ancestors are pending, the target must not descend again
+    while (node != NULL && node->key != key) {
+      bst_cursor_push(cursor, node);
+      node = key < node->key ? node->left : node->right;
+    }
+    if (node == NULL) {
+      cursor->size = 0;
+      return false;
+    }
+    bst_cursor_push(cursor, node);
+    cursor->last = node->right;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Uvolnění zdrojů kurzoru.
+ */
+void bst_cursor_dispose(bst_cursor_t *cursor)
+{
+  if (cursor->stack != cursor->inline_stack) {
+    free(cursor->stack);
+  }
+  cursor->stack = cursor->inline_stack;
+  cursor->capacity = BST_CURSOR_INLINE_SIZE;
+  cursor->size = 0;
+  cursor->descend = NULL;
+  cursor->last = NULL;
+}
+
+/*
+ * Pomocná funkce, která z pole uzlů seřazených podle klíče propojí dokonale
+ * vyvážený strom a vrátí jeho kořen. Hloubka rekurze je log2(count).
+ */
+static bst_node_t *bst_link_balanced(bst_node_t **nodes, int count)
+{
+  if (count == 0) {
+    return NULL;
+  }
+  int middle = count / 2;
+  bst_node_t *root = nodes[middle];
+  root->left = bst_link_balanced(nodes, middle);
+  root->right = bst_link_balanced(nodes + middle + 1, count - middle - 1);
+  BST_UPDATE_SIZE(root);
+  return root;
+}
+
+/*
+ * Pomocná funkce, která alokuje uzly dokonale vyváženého stromu v pořadí
+ * preorder, takže uzly horních úrovní leží v paměti blízko sebe.
+ */
+static bst_node_t *bst_build_balanced(const int keys[],
+                                      const bst_node_content_t values[],
+                                      int count)
+{
+  if (count == 0) {
+    return NULL;
+  }
+  int middle = count / 2;
+  bst_node_t *root = malloc(sizeof(bst_node_t));
+  if (root == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  root->key = keys[middle];
+  root->content = values[middle];
+  root->left = bst_build_balanced(keys, values, middle);
+  root->right = bst_build_balanced(keys + middle + 1, values + middle + 1,
+                                   count - middle - 1);
+  BST_UPDATE_SIZE(root);
+  return root;
+}
+
+/*
+ * Pomocná funkce, která uloží uzly stromu do pole items v pořadí inorder.
+ */
+static void bst_flatten(bst_node_t *tree, bst_items_t *items)
+{
+  BST_ITEMS_RESERVE_TREE(items, tree);
+  bst_cursor_t cursor;
+  bst_cursor_init(&cursor, tree, BST_INORDER);
+  bst_node_t *node;
+  while ((node = bst_cursor_next(&cursor)) != NULL) {
+    bst_add_node_to_items(node, items);
+  }
+  bst_cursor_dispose(&cursor);
+}
+
+/*
+ * Vytvoření dokonale vyváženého stromu ze seřazených dvojic klíč/hodnota
+ * v čase O(n) bez jediného porovnání klíčů.
+ *
+ * Klíče musí být ostře rostoucí. Původní obsah *tree se nebere v úvahu,
+ * strom má být prázdný. Hodnoty přechází do vlastnictví stromu.
+ */
+void bst_build_sorted(bst_node_t **tree, const int keys[],
+                      const bst_node_content_t values[], int count)
+{
+  *tree = bst_build_balanced(keys, values, count);
+}
+
+/*
+ * Vložení seřazené dávky dvojic klíč/hodnota do existujícího stromu.
+ *
+ * Uzly stromu se projdou jednou v pořadí inorder, slijí se s dávkou a znovu
+ * propojí do vyváženého stromu. Místo count sestupů od kořene tak stačí
+ * O(n + count) kroků a výsledný strom je vyvážený. Existující klíče dostanou
+ * novou hodnotu (stará je uvolněna). Klíče dávky musí být ostře rostoucí.
+ */
+void bst_bulk_insert(bst_node_t **tree, const int keys[],
+                     const bst_node_content_t values[], int count)
+{
+  bst_items_t existing;
+  bst_items_init(&existing);
+  bst_flatten(*tree, &existing);
+
+  bst_items_t merged;
+  bst_items_init(&merged);
+  bst_items_reserve(&merged, existing.size + count); // upper bound, no regrowth
+  int index = 0;
+  int batch = 0;
+  while (index < existing.size || batch < count) {
+    if (batch == count ||
+        (index < existing.size && existing.nodes[index]->key < keys[batch])) {
+      bst_add_node_to_items(existing.nodes[index++], &merged); // keep the node
+    }
+    else if (index < existing.size && existing.nodes[index]->key == keys[batch]) {
+      bst_node_t *node = existing.nodes[index++]; // replace the value
+      if (node->content.value != NULL) {
+        free(node->content.value);
+      }
+      node->content = values[batch++];
+      bst_add_node_to_items(node, &merged);
+    }
+    else {
+      bst_node_t *node = malloc(sizeof(bst_node_t)); // new key from the batch
+      if (node == NULL) {
+        exit(EXIT_FAILURE); // error handling
+      }
+      node->key = keys[batch];
+      node->content = values[batch++];
+      bst_add_node_to_items(node, &merged);
+    }
+  }
+
+  *tree = bst_link_balanced(merged.nodes, merged.size);
+  free(existing.nodes);
+  free(merged.nodes);
+}
+
+/*
+ * Vyvážení stromu.
+ *
+ * Uzly se projdou v pořadí inorder a znovu propojí do dokonale vyváženého
+ * stromu v čase O(n), žádný uzel se nealokuje ani neuvolňuje.
+ */
+void bst_balance(bst_node_t **tree)
+{
+  bst_items_t items;
+  bst_items_init(&items);
+  bst_flatten(*tree, &items);
+  *tree = bst_link_balanced(items.nodes, items.size);
+  free(items.nodes);
+}
+
+/*
+ * Rozdělení stromu podle klíče key: do *lt přijdou uzly s menším klíčem, do
+ * *ge uzly s klíčem větším nebo rovným. Původní strom zanikne.
+ *
+ * Uzly na cestě hledání key se postupně věší na pravý okraj *lt a levý okraj
+ * *ge, ostatní podstromy zůstávají, jak jsou. Stačí tak O(h) kroků bez
+ * alokace a výška žádné části nevzroste, na vyváženém stromu je to O(log n).
+ */
+void bst_split(bst_node_t *tree, int key, bst_node_t **lt, bst_node_t **ge)
+{
+  bst_node_t **lt_end = lt;   // where the next smaller node is attached
+  bst_node_t **ge_end = ge;   // where the next greater or equal node is attached
+#ifdef BST_ORDER_STATISTICS
+  int lt_size = 0;
+  int ge_size = 0;
+#endif
+  while (tree != NULL) {
+    if (tree->key < key) {
+      *lt_end = tree;
+      lt_end = &tree->right;
+#ifdef BST_ORDER_STATISTICS
+      lt_size += 1 + bst_size(tree->left);
+#endif
+      tree = tree->right;
+    }
+    else {
+      *ge_end = tree;
+      ge_end = &tree->left;
+#ifdef BST_ORDER_STATISTICS
+      ge_size += 1 + bst_size(tree->right);
+#endif
+      tree = tree->left;
+    }
+  }
+  *lt_end = NULL;
+  *ge_end = NULL;
+
+#ifdef BST_ORDER_STATISTICS
+  // only the spine nodes changed, walk them from the top with the running totals
+  for (bst_node_t *node = *lt; node != NULL; node = node->right) {
+    node->size = lt_size;
+    lt_size -= 1 + bst_size(node->left);
+  }
+  for (bst_node_t *node = *ge; node != NULL; node = node->left) {
+    node->size = ge_size;
+    ge_size -= 1 + bst_size(node->right);
+  }
+#endif
+}
+
+/*
+ * Spojení dvou stromů, kde jsou všechny klíče stromu a menší než klíče
+ * stromu b. Největší uzel stromu a se vyjme a stane se kořenem nad oběma
+ * stromy, takže výška vzroste nejvýše o jedna a stačí O(h) kroků.
+ */
+bst_node_t *bst_join(bst_node_t *a, bst_node_t *b)
+{
+  if (a == NULL) {
+    return b;
+  }
+  if (b == NULL) {
+    return a;
+  }
+  bst_node_t **link = &a;
+  while ((*link)->right != NULL) {
+    BST_ADJUST_SIZE(*link, -1); // the rightmost node leaves every subtree on the way
+    link = &(*link)->right;
+  }
+  bst_node_t *root = *link;
+  *link = root->left;
+  root->left = a; // what is left of a, even when root was its root
+  root->right = b;
+  BST_UPDATE_SIZE(root);
+  return root;
+}
+
+/*
+ * Sjednocení dvou stromů v čase O(n + m). Oba stromy se projdou v pořadí
+ * inorder, slijí se a propojí do vyváženého stromu, žádný uzel se nealokuje.
+ * Pokud je klíč v obou stromech, zůstane uzel ze stromu b a uzel ze stromu
+ * a se uvolní i s hodnotou. Původní stromy zaniknou.
+ */
+bst_node_t *bst_union(bst_node_t *a, bst_node_t *b)
+{
+  bst_items_t first;
+  bst_items_init(&first);
+  bst_items_t second;
+  bst_items_init(&second);
+  bst_flatten(a, &first);
+  bst_flatten(b, &second);
+
+  bst_items_t merged;
+  bst_items_init(&merged);
+  bst_items_reserve(&merged, first.size + second.size);
+  int i = 0;
+  int j = 0;
+  while (i < first.size || j < second.size) {
+    if (j == second.size ||
+        (i < first.size && first.nodes[i]->key < second.nodes[j]->key)) {
+      merged.nodes[merged.size++] = first.nodes[i++];
+    }
+    else {
+      if (i < first.size && first.nodes[i]->key == second.nodes[j]->key) {
+        bst_node_t *duplicate = first.nodes[i++];
+        if (duplicate->content.value != NULL) {
+          free(duplicate->content.value);
+        }
+        free(duplicate);
+      }
+      merged.nodes[merged.size++] = second.nodes[j++];
+    }
+  }
+
+  bst_node_t *tree = bst_link_balanced(merged.nodes, merged.size);
+  free(first.nodes);
+  free(second.nodes);
+  free(merged.nodes);
+  return tree;
+}
+
+#ifdef BST_ORDER_STATISTICS
+
+/*
+ * Počet uzlů podstromu, pro prázdný strom 0.
+ */
+int bst_size(bst_node_t *tree)
+{
+  return tree != NULL ? tree->size : 0;
+}
+
+/*
+ * Pořadí klíče ve stromu (počet klíčů menších než key) v čase O(h).
+ */
+int bst_rank(bst_node_t *tree, int key)
+{
+  int rank = 0;
+  bst_node_t *active_node = tree;
+  while (active_node != NULL) {
+    if (key <= active_node->key) {
+      active_node = active_node->left;
+    }
+    else { // the node and its whole left subtree are smaller
+      rank += 1 + bst_size(active_node->left);
+      active_node = active_node->right;
+    }
+  }
+  return rank;
+}
+
+/*
+ * Nalezení k-tého nejmenšího uzlu (počítáno od 0) v čase O(h).
+ *
+ * Pokud strom obsahuje nejvýše k uzlů, funkce vrací NULL.
+ */
+bst_node_t *bst_select(bst_node_t *tree, int k)
+{
+  bst_node_t *active_node = tree;
+  while (active_node != NULL && k >= 0) {
+    int left_size = bst_size(active_node->left);
+    if (k < left_size) {
+      active_node = active_node->left;
+    }
+    else if (k == left_size) {
+      return active_node;
+    }
+    else { // skip the left subtree and this node
+      k -= left_size + 1;
+      active_node = active_node->right;
+    }
+  }
+  return NULL;
+}
+
+#endif // BST_ORDER_STATISTICS
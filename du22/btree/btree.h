@@ -7,6 +7,7 @@
 #define IAL_BTREE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 // výčet datových typů hodnoty
 typedef enum {
@@ -23,36 +24,132 @@ typedef struct bst_node_content {
 // Uzel stromu
 typedef struct bst_node {
   int key;                     // klíč
+#ifdef BST_ORDER_STATISTICS
+  int size;                    // počet uzlů podstromu včetně tohoto uzlu
+#endif
   bst_node_content_t content;  // hodnota
   struct bst_node *left;       // levý potomek
   struct bst_node *right;      // pravý potomek
 } bst_node_t;
 
 void bst_init(bst_node_t **tree);
-void bst_insert(bst_node_t **tree, char key, bst_node_content_t value);
-bool bst_search(bst_node_t *tree, char key, bst_node_content_t **value);
-void bst_delete(bst_node_t **tree, char key);
+void bst_insert(bst_node_t **tree, int key, bst_node_content_t value);
+bool bst_search(bst_node_t *tree, int key, bst_node_content_t **value);
+void bst_delete(bst_node_t **tree, int key);
 void bst_dispose(bst_node_t **tree);
+bst_node_t *bst_lower_bound(bst_node_t *tree, int key);
+bst_node_t *bst_upper_bound(bst_node_t *tree, int key);
+
+// Blok areny pro pole uzlů
+typedef struct bst_arena_block {
+  struct bst_arena_block *next;   // předchozí blok
+  size_t used;                    // obsazené bajty
+  size_t capacity;                // velikost dat v bajtech
+  max_align_t data[];             // data
+} bst_arena_block_t;
+
+// Arena: pole se z ní jen odkrajují a uvolňují se všechna najednou
+typedef struct bst_arena {
+  bst_arena_block_t *block;   // aktuální blok
+  size_t total;               // součet velikostí všech bloků
+} bst_arena_t;
 
 // Pole uzlu
 typedef struct bst_items {
   bst_node_t **nodes;     // pole uzlu
   int capacity;           // kapacita alokované paměti v počtu položek
   int size;               // aktuální velikost pole v počtu položek
+  bst_arena_t *arena;     // arena, ze které je pole, NULL = halda
 } bst_items_t;
 
+// Pole se inicializuje jen přes bst_items_init (halda) nebo
+// bst_items_init_arena (arena), aby bylo nastavené i pole arena.
 void bst_add_node_to_items(bst_node_t* node, bst_items_t *items);
+void bst_items_init(bst_items_t *items);
+void bst_items_reserve(bst_items_t *items, int capacity);
+void bst_items_clear(bst_items_t *items);
+void bst_items_init_arena(bst_items_t *items, bst_arena_t *arena, int capacity);
+
+void bst_arena_init(bst_arena_t *arena, size_t capacity);
+void *bst_arena_alloc(bst_arena_t *arena, size_t size);
+void bst_arena_reset(bst_arena_t *arena);
+void bst_arena_dispose(bst_arena_t *arena);
 
 void bst_preorder(bst_node_t *tree, bst_items_t *items);
 void bst_inorder(bst_node_t *tree, bst_items_t *items);
 void bst_postorder(bst_node_t *tree, bst_items_t *items);
 
+// Funkce volaná pro každý navštívený uzel
+typedef void (*bst_visit_t)(bst_node_t *node, void *ctx);
+
+void bst_items_visit(bst_node_t *node, void *items);
+
+void bst_range(bst_node_t *tree, int low, int high, bst_visit_t visit, void *ctx);
+
+void bst_morris_preorder(bst_node_t *tree, bst_visit_t visit, void *ctx);
+void bst_morris_inorder(bst_node_t *tree, bst_visit_t visit, void *ctx);
+
+// Pořadí průchodu
+typedef enum {
+  BST_PREORDER = 0,
+  BST_INORDER,
+  BST_POSTORDER
+} bst_order_t;
+
+// Počet uzlů zásobníku kurzoru uložených přímo ve struktuře (bez alokace)
+#define BST_CURSOR_INLINE_SIZE 32
+
+// Kurzor pro postupný průchod stromem
+typedef struct bst_cursor {
+  bst_node_t *root;                                   // procházený strom
+  bst_order_t order;                                  // pořadí průchodu
+  bst_node_t *inline_stack[BST_CURSOR_INLINE_SIZE];   // zásobník bez alokace
+  bst_node_t **stack;                                 // aktuální zásobník uzlů
+  int size;                                           // počet uzlů v zásobníku
+  int capacity;                                       // kapacita zásobníku
+  bst_node_t *descend;                                // postorder: podstrom k sestupu
+  bst_node_t *last;                                   // postorder: poslední vrácený uzel
+} bst_cursor_t;
+
+void bst_cursor_init(bst_cursor_t *cursor, bst_node_t *tree, bst_order_t order);
+bst_node_t *bst_cursor_next(bst_cursor_t *cursor);
+bool bst_cursor_seek(bst_cursor_t *cursor, int key);
+void bst_cursor_dispose(bst_cursor_t *cursor);
+
 void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree);
 
+#ifdef BST_ORDER_STATISTICS
+// Přepočítá velikost podstromu uzlu z velikostí jeho potomků
+#define BST_UPDATE_SIZE(node)                                                  \
+  ((node)->size = 1 + bst_size((node)->left) + bst_size((node)->right))
+
+// Změní velikost podstromu uzlu o delta (před sestupem, kde je změna jistá)
+#define BST_ADJUST_SIZE(node, delta) ((node)->size += (delta))
+
+// Zvětší pole items předem přesně na uzly stromu (velikost je v kořeni)
+#define BST_ITEMS_RESERVE_TREE(items, tree)                                    \
+  bst_items_reserve((items), (items)->size + bst_size(tree))
+
+int bst_size(bst_node_t *tree);
+int bst_rank(bst_node_t *tree, int key);
+bst_node_t *bst_select(bst_node_t *tree, int k);
+#else
+#define BST_UPDATE_SIZE(node) ((void)0)
+#define BST_ADJUST_SIZE(node, delta) ((void)0)
+#define BST_ITEMS_RESERVE_TREE(items, tree) ((void)0)
+#endif
+
 void bst_print_node_content(bst_node_content_t *content);
 void bst_print_node(bst_node_t *node);
 
+void bst_build_sorted(bst_node_t **tree, const int keys[],
+                      const bst_node_content_t values[], int count);
+void bst_bulk_insert(bst_node_t **tree, const int keys[],
+                     const bst_node_content_t values[], int count);
 void bst_balance(bst_node_t **tree);
+void bst_split(bst_node_t *tree, int key, bst_node_t **lt, bst_node_t **ge);
+bst_node_t *bst_join(bst_node_t *a, bst_node_t *b);
+bst_node_t *bst_union(bst_node_t *a, bst_node_t *b);
 void letter_count(bst_node_t **letter_frequency_tree, char *input);
 
 #endif
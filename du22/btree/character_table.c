@@ -0,0 +1,393 @@
+/*
+ * Strom postav se sekundárními indexy
+ *
+ * Hodnota uzlu stromu je záznam, který začíná postavou, za ní nese číslo
+ * pozice a kopii jména. Stromu tak stačí jediné free na hodnotu a z výsledku
+ * bst_search se rovnou zjistí pozice postavy v indexech.
+ */
+
+#include "character_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Záznam uložený jako hodnota uzlu stromu
+typedef struct character_record {
+  character_t character;   // postava (musí být první, ukazuje na ni content.value)
+  int slot;                // pozice v indexech
+  char name[];             // kopie jména
+} character_record_t;
+
+#define CHARACTER_WORD(slot) ((slot) / 64)
+#define CHARACTER_BIT(slot) ((uint64_t)1 << ((slot) % 64))
+
+static uint32_t character_name_hash(const char *name)
+{
+  uint32_t hash = 2166136261u; // FNV-1a
+  for (; *name != '\0'; name++) {
+    hash = (hash ^ (unsigned char)*name) * 16777619u;
+  }
+  return hash;
+}
+
+/*
+ * Pozice jména v hašovací tabulce, nebo volná pozice, kam patří.
+ */
+static int character_name_find(const character_table_t *table, const char *name)
+{
+  int index = character_name_hash(name) & table->names_mask;
+  while (table->names[index] != -1 &&
+         strcmp(table->slots[table->names[index]].character->name, name) != 0) {
+    index = (index + 1) & table->names_mask;
+  }
+  return index;
+}
+
+static void character_name_grow(character_table_t *table)
+{
+  int *old = table->names;
+  int old_size = table->names_mask + 1;
+  table->names_mask = 2 * old_size - 1;
+  table->names = malloc(2 * old_size * sizeof(int));
+  if (table->names == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  memset(table->names, -1, 2 * old_size * sizeof(int));
+  for (int i = 0; i < old_size; i++) {
+    if (old[i] != -1) {
+      const char *name = table->slots[old[i]].character->name;
+      table->names[character_name_find(table, name)] = old[i];
+    }
+  }
+  free(old);
+}
+
+/*
+ * Odstranění jména z tabulky. Následující položky téhož shluku se posunou
+ * zpět, aby je vyhledávání stále našlo (bez náhrobků).
+ */
+static void character_name_unlink(character_table_t *table, int hole)
+{
+  table->names[hole] = -1;
+  for (int index = (hole + 1) & table->names_mask; table->names[index] != -1;
+       index = (index + 1) & table->names_mask) {
+    const char *name = table->slots[table->names[index]].character->name;
+    int home = character_name_hash(name) & table->names_mask;
+    // the entry may move to the hole unless its home lies cyclically in (hole, index]
+    bool stays = hole <= index ? (home > hole && home <= index)
+                               : (home > hole || home <= index);
+    if (!stays) {
+      table->names[hole] = table->names[index];
+      table->names[index] = -1;
+      hole = index;
+    }
+  }
+  table->names_used--;
+}
+
+/*
+ * Inicializace prázdného stromu postav. Parametr indexes určuje, které
+ * sekundární indexy se budou udržovat (CHARACTER_INDEX_*).
+ */
+void character_table_init(character_table_t *table, int indexes)
+{
+  bst_init(&table->tree);
+  table->indexes = indexes;
+  table->slots = NULL;
+  table->capacity = 0;
+  table->used = 0;
+  table->free = -1;
+  table->live = NULL;
+  for (int i = 0; i < CHARACTER_CLASS_COUNT; i++) {
+    table->classes[i] = NULL;
+  }
+  for (int i = 0; i < CHARACTER_LEVEL_COUNT; i++) {
+    table->level_head[i] = -1;
+  }
+  table->names = NULL;
+  table->names_mask = 0;
+  table->names_used = 0;
+}
+
+// Zvětší bitmapu na words slov, nová slova jsou nulová
+static uint64_t *character_bitmap_grow(uint64_t *bitmap, int old_words, int words)
+{
+  bitmap = realloc(bitmap, words * sizeof(uint64_t));
+  if (bitmap == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  memset(bitmap + old_words, 0, (words - old_words) * sizeof(uint64_t));
+  return bitmap;
+}
+
+static int character_slot_alloc(character_table_t *table)
+{
+  if (table->free != -1) {
+    int slot = table->free;
+    table->free = table->slots[slot].next_name;
+    return slot;
+  }
+  if (table->used == table->capacity) {
+    int capacity = table->capacity > 0 ? 2 * table->capacity : 64;
+    character_slot_t *slots = realloc(table->slots, capacity * sizeof(character_slot_t));
+    if (slots == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    table->slots = slots;
+    int old_words = CHARACTER_WORD(table->capacity);
+    int words = CHARACTER_WORD(capacity);
+    table->live = character_bitmap_grow(table->live, old_words, words);
+    if (table->indexes & CHARACTER_INDEX_CLASS) {
+      for (int i = 0; i < CHARACTER_CLASS_COUNT; i++) {
+        table->classes[i] = character_bitmap_grow(table->classes[i], old_words, words);
+      }
+    }
+    table->capacity = capacity;
+  }
+  return table->used++;
+}
+
+static void character_index_add(character_table_t *table, int slot)
+{
+  character_slot_t *entry = &table->slots[slot];
+  character_t *character = entry->character;
+  table->live[CHARACTER_WORD(slot)] |= CHARACTER_BIT(slot);
+
+  if (table->indexes & CHARACTER_INDEX_CLASS) {
+    table->classes[character->character_class][CHARACTER_WORD(slot)] |= CHARACTER_BIT(slot);
+  }
+
+  if (table->indexes & CHARACTER_INDEX_LEVEL) {
+    int head = table->level_head[character->level];
+    entry->prev_level = -1;
+    entry->next_level = head;
+    if (head != -1) {
+      table->slots[head].prev_level = slot;
+    }
+    table->level_head[character->level] = slot;
+  }
+
+  if (table->indexes & CHARACTER_INDEX_NAME) {
+    if (table->names == NULL) {
+      table->names = malloc(16 * sizeof(int));
+      if (table->names == NULL) {
+        exit(EXIT_FAILURE); // error handling
+      }
+      memset(table->names, -1, 16 * sizeof(int));
+      table->names_mask = 15;
+    }
+    int index = character_name_find(table, character->name);
+    int head = table->names[index];
+    entry->prev_name = -1;
+    entry->next_name = head;
+    if (head != -1) {
+      table->slots[head].prev_name = slot;
+    }
+    table->names[index] = slot;
+    if (head == -1 && ++table->names_used * 2 > table->names_mask + 1) {
+      character_name_grow(table);
+    }
+  }
+}
+
+static void character_index_remove(character_table_t *table, int slot)
+{
+  character_slot_t *entry = &table->slots[slot];
+  character_t *character = entry->character;
+  table->live[CHARACTER_WORD(slot)] &= ~CHARACTER_BIT(slot);
+
+  if (table->indexes & CHARACTER_INDEX_CLASS) {
+    table->classes[character->character_class][CHARACTER_WORD(slot)] &= ~CHARACTER_BIT(slot);
+  }
+
+  if (table->indexes & CHARACTER_INDEX_LEVEL) {
+    if (entry->prev_level != -1) {
+      table->slots[entry->prev_level].next_level = entry->next_level;
+    }
+    else {
+      table->level_head[character->level] = entry->next_level;
+    }
+    if (entry->next_level != -1) {
+      table->slots[entry->next_level].prev_level = entry->prev_level;
+    }
+  }
+
+  if (table->indexes & CHARACTER_INDEX_NAME) {
+    if (entry->prev_name != -1) {
+      table->slots[entry->prev_name].next_name = entry->next_name;
+    }
+    else {
+      int index = character_name_find(table, character->name);
+      if (entry->next_name != -1) {
+        table->names[index] = entry->next_name; // the next one becomes the head
+      }
+      else {
+        character_name_unlink(table, index);
+      }
+    }
+    if (entry->next_name != -1) {
+      table->slots[entry->next_name].prev_name = entry->prev_name;
+    }
+  }
+
+  entry->character = NULL;
+  entry->next_name = table->free;
+  table->free = slot;
+}
+
+/*
+ * Vložení postavy pod klíč key. Jméno se zkopíruje, volající si původní
+ * řetězec ponechává. Existující postava se stejným klíčem se nahradí.
+ */
+void character_table_insert(character_table_t *table, int key,
+                            character_t character)
+{
+  bst_node_content_t *content;
+  if (bst_search(table->tree, key, &content)) {
+    // bst_insert frees the old record, only the indexes are left to us
+    character_index_remove(table, ((character_record_t *)content->value)->slot);
+  }
+
+  const char *name = character.name != NULL ? character.name : "";
+  size_t length = strlen(name);
+  character_record_t *record = malloc(sizeof(character_record_t) + length + 1);
+  if (record == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  memcpy(record->name, name, length + 1);
+  record->character = character;
+  record->character.name = record->name;
+  record->slot = character_slot_alloc(table);
+
+  character_slot_t *entry = &table->slots[record->slot];
+  entry->key = key;
+  entry->character = &record->character;
+  character_index_add(table, record->slot);
+
+  bst_insert(&table->tree, key,
+             (bst_node_content_t){.value = record, .type = CHARACTER_T});
+}
+
+/*
+ * Smazání postavy s klíčem key ze stromu i ze všech indexů.
+ */
+void character_table_delete(character_table_t *table, int key)
+{
+  bst_node_content_t *content;
+  if (!bst_search(table->tree, key, &content)) {
+    return;
+  }
+  character_index_remove(table, ((character_record_t *)content->value)->slot);
+  bst_delete(&table->tree, key);
+}
+
+static bool character_query_match(const character_query_t *query,
+                                  const character_t *character)
+{
+  if (query->class_mask != 0 &&
+      !(query->class_mask & (1u << character->character_class))) {
+    return false;
+  }
+  if (character->level < query->min_level || character->level > query->max_level) {
+    return false;
+  }
+  return query->name == NULL || strcmp(character->name, query->name) == 0;
+}
+
+/*
+ * Zavolá visit pro každou postavu, která splňuje všechny podmínky dotazu,
+ * a vrátí jejich počet. Podle jména se hledá v řetězci pozic se stejným
+ * jménem, jinak se bitmapy povolání a úrovní spojí průnikem a procházejí
+ * se jen zbylé pozice. Chybějící index se nahradí kontrolou podmínky při
+ * procházení. Pořadí výsledků není určené.
+ */
+int character_table_query(const character_table_t *table,
+                          const character_query_t *query,
+                          character_table_visit_t visit, void *ctx)
+{
+  int found = 0;
+  if (table->used == 0 || query->min_level > query->max_level ||
+      query->max_level < 0 || query->min_level >= CHARACTER_LEVEL_COUNT) {
+    return 0;
+  }
+
+  if (query->name != NULL && (table->indexes & CHARACTER_INDEX_NAME)) {
+    for (int slot = table->names[character_name_find(table, query->name)];
+         slot != -1; slot = table->slots[slot].next_name) {
+      const character_slot_t *entry = &table->slots[slot];
+      if (character_query_match(query, entry->character)) {
+        visit(entry->key, entry->character, ctx);
+        found++;
+      }
+    }
+    return found;
+  }
+
+  int words = CHARACTER_WORD(table->capacity);
+  uint64_t *candidates = malloc((words + 1) * sizeof(uint64_t));
+  if (candidates == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  memcpy(candidates, table->live, words * sizeof(uint64_t));
+
+  if (query->class_mask != 0 && (table->indexes & CHARACTER_INDEX_CLASS)) {
+    for (int w = 0; w < words; w++) {
+      uint64_t classes = 0;
+      for (int i = 0; i < CHARACTER_CLASS_COUNT; i++) {
+        if (query->class_mask & (1u << i)) {
+          classes |= table->classes[i][w];
+        }
+      }
+      candidates[w] &= classes;
+    }
+  }
+
+  int min_level = query->min_level > 0 ? query->min_level : 0;
+  int max_level = query->max_level < CHARACTER_LEVEL_COUNT ? query->max_level
+                                                           : CHARACTER_LEVEL_COUNT - 1;
+  if ((min_level > 0 || max_level < CHARACTER_LEVEL_COUNT - 1) &&
+      (table->indexes & CHARACTER_INDEX_LEVEL)) {
+    // bitmap of the level buckets in the range, then intersect
+    uint64_t *levels = calloc(words + 1, sizeof(uint64_t));
+    if (levels == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    for (int level = min_level; level <= max_level; level++) {
+      for (int slot = table->level_head[level]; slot != -1;
+           slot = table->slots[slot].next_level) {
+        levels[CHARACTER_WORD(slot)] |= CHARACTER_BIT(slot);
+      }
+    }
+    for (int w = 0; w < words; w++) {
+      candidates[w] &= levels[w];
+    }
+    free(levels);
+  }
+
+  for (int w = 0; w < words; w++) {
+    for (uint64_t bits = candidates[w]; bits != 0; bits &= bits - 1) {
+      int slot = w * 64 + __builtin_ctzll(bits);
+      const character_slot_t *entry = &table->slots[slot];
+      if (character_query_match(query, entry->character)) {
+        visit(entry->key, entry->character, ctx);
+        found++;
+      }
+    }
+  }
+  free(candidates);
+  return found;
+}
+
+/*
+ * Uvolnění stromu i indexů a návrat do stavu po inicializaci.
+ */
+void character_table_dispose(character_table_t *table)
+{
+  bst_dispose(&table->tree);
+  free(table->slots);
+  free(table->live);
+  for (int i = 0; i < CHARACTER_CLASS_COUNT; i++) {
+    free(table->classes[i]);
+  }
+  free(table->names);
+  character_table_init(table, table->indexes);
+}
@@ -0,0 +1,81 @@
+/*
+ * Hlavičkový soubor pro strom postav se sekundárními indexy.
+ *
+ * Postavy jsou uložené v obyčejném binárním vyhledávacím stromu podle klíče
+ * (hodnoty typu CHARACTER_T). Vkládání a mazání přes character_table_*
+ * navíc udržuje zvolené sekundární indexy:
+ *  - hašovací index podle jména,
+ *  - bitmapu pozic pro každé povolání,
+ *  - seznam pozic pro každou úroveň (úroveň má jen 256 hodnot, seznamy
+ *    v pořadí úrovní tvoří uspořádaný index).
+ * Každá postava má pevnou pozici (slot), bitmapy jsou indexované pozicemi
+ * a dotaz výsledky indexů průnikem bitmap spojí.
+ */
+
+#ifndef IAL_BTREE_CHARACTER_TABLE_H
+#define IAL_BTREE_CHARACTER_TABLE_H
+
+#include "btree.h"
+#include "character.h"
+#include <stdint.h>
+
+// Počet povolání
+#define CHARACTER_CLASS_COUNT (Fighter + 1)
+
+// Počet úrovní
+#define CHARACTER_LEVEL_COUNT 256
+
+// volitelné indexy
+#define CHARACTER_INDEX_NAME 0x01
+#define CHARACTER_INDEX_CLASS 0x02
+#define CHARACTER_INDEX_LEVEL 0x04
+#define CHARACTER_INDEX_ALL 0x07
+
+// Pozice postavy v indexech
+typedef struct character_slot {
+  int key;                  // klíč postavy ve stromu
+  character_t *character;   // postava (hodnota uzlu stromu), NULL = volná pozice
+  int next_name;            // další pozice se stejným jménem (volná: další volná)
+  int prev_name;            // předchozí pozice se stejným jménem
+  int next_level;           // další pozice se stejnou úrovní
+  int prev_level;           // předchozí pozice se stejnou úrovní
+} character_slot_t;
+
+// Strom postav s indexy
+typedef struct character_table {
+  bst_node_t *tree;                                 // postavy podle klíče
+  int indexes;                                      // udržované indexy CHARACTER_INDEX_*
+  character_slot_t *slots;                          // pozice
+  int capacity;                                     // počet pozic
+  int used;                                         // počet kdy použitých pozic
+  int free;                                         // první volná pozice nebo -1
+  uint64_t *live;                                   // bitmapa obsazených pozic
+  uint64_t *classes[CHARACTER_CLASS_COUNT];         // bitmapa pozic podle povolání
+  int level_head[CHARACTER_LEVEL_COUNT];            // první pozice s úrovní nebo -1
+  int *names;                                       // hašovací tabulka jméno -> první pozice
+  int names_mask;                                   // velikost tabulky jmen - 1
+  int names_used;                                   // počet různých jmen
+} character_table_t;
+
+// Dotaz: podmínky se spojují logickým součinem
+typedef struct character_query {
+  const char *name;        // jméno nebo NULL pro libovolné
+  unsigned class_mask;     // množina povolání (1 << povolání), 0 pro libovolné
+  int min_level;           // nejmenší úroveň (včetně)
+  int max_level;           // největší úroveň (včetně)
+} character_query_t;
+
+// Funkce volaná pro každou nalezenou postavu
+typedef void (*character_table_visit_t)(int key, character_t *character,
+                                        void *ctx);
+
+void character_table_init(character_table_t *table, int indexes);
+void character_table_insert(character_table_t *table, int key,
+                            character_t character);
+void character_table_delete(character_table_t *table, int key);
+int character_table_query(const character_table_t *table,
+                          const character_query_t *query,
+                          character_table_visit_t visit, void *ctx);
+void character_table_dispose(character_table_t *table);
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Sloupcový výstup průchodu stromem
+ */
+
+#include "columns.h"
+#include <stdlib.h>
+
+/*
+ * Inicializace prázdného výstupu s předem alokovanou kapacitou (může být 0).
+ */
+void bst_columns_init(bst_columns_t *columns, int capacity)
+{
+  columns->keys = NULL;
+  columns->types = NULL;
+  columns->values = NULL;
+  columns->integers = NULL;
+  columns->size = 0;
+  columns->capacity = 0;
+  bst_columns_reserve(columns, capacity);
+}
+
+/*
+ * Zajistí kapacitu alespoň capacity uzlů. Uložené uzly zůstávají.
+ */
+void bst_columns_reserve(bst_columns_t *columns, int capacity)
+{
+  if (capacity <= columns->capacity) {
+    return;
+  }
+  int *keys = realloc(columns->keys, capacity * sizeof(int));
+  if (keys == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  columns->keys = keys;
+  uint8_t *types = realloc(columns->types, capacity * sizeof(uint8_t));
+  if (types == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  columns->types = types;
+  void **values = realloc(columns->values, capacity * sizeof(void *));
+  if (values == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  columns->values = values;
+  int *integers = realloc(columns->integers, capacity * sizeof(int));
+  if (integers == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  columns->integers = integers;
+  columns->capacity = capacity;
+}
+
+/*
+ * Přidání uzlu na konec sloupců.
+ */
+void bst_columns_add(bst_columns_t *columns, bst_node_t *node)
+{
+  if (columns->size == columns->capacity) {
+    bst_columns_reserve(columns, columns->capacity * 2 + 8);
+  }
+  int i = columns->size++;
+  columns->keys[i] = node->key;
+  columns->types[i] = node->content.type;
+  columns->values[i] = node->content.value;
+  columns->integers[i] = node->content.type == INTEGER && node->content.value != NULL
+                             ? *(int *)node->content.value
+                             : 0;
+}
+
+/*
+ * Přidá uzly stromu v pořadí order na konec sloupců. S BST_ORDER_STATISTICS
+ * se kapacita zvětší předem přesně na potřebnou velikost.
+ */
+void bst_columns_export(bst_node_t *tree, bst_order_t order, bst_columns_t *columns)
+{
+#ifdef BST_ORDER_STATISTICS
+  bst_columns_reserve(columns, columns->size + bst_size(tree));
+#endif
+  bst_cursor_t cursor;
+  bst_cursor_init(&cursor, tree, order);
+  bst_node_t *node;
+  while ((node = bst_cursor_next(&cursor)) != NULL) {
+    bst_columns_add(columns, node);
+  }
+  bst_cursor_dispose(&cursor);
+}
+
+/*
+ * Součet hodnot typu INTEGER.
+ */
+int64_t bst_columns_sum(const bst_columns_t *columns)
+{
+  const int *integers = columns->integers;
+  int64_t sum = 0;
+  for (int i = 0; i < columns->size; i++) {
+    sum += integers[i];
+  }
+  return sum;
+}
+
+/*
+ * Počet uzlů s klíčem v intervalu [low, high], bez ohledu na pořadí průchodu.
+ */
+int bst_columns_count_range(const bst_columns_t *columns, int low, int high)
+{
+  const int *keys = columns->keys;
+  int count = 0;
+  for (int i = 0; i < columns->size; i++) { // branchless, vectorizable at -O3
+    count += (keys[i] >= low) & (keys[i] <= high);
+  }
+  return count;
+}
+
+/*
+ * Vyprázdnění sloupců bez uvolnění paměti, pro opakované plnění.
+ */
+void bst_columns_clear(bst_columns_t *columns)
+{
+  columns->size = 0;
+}
+
+/*
+ * Uvolnění sloupců.
+ */
+void bst_columns_dispose(bst_columns_t *columns)
+{
+  free(columns->keys);
+  free(columns->types);
+  free(columns->values);
+  free(columns->integers);
+  bst_columns_init(columns, 0);
+}
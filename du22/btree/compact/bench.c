@@ -0,0 +1,186 @@
+/*
+ * Srovnání kompaktního stromu s binárním vyhledávacím stromem (iterativní
+ * varianta). Každý strom se měří v samostatném procesu, aby maximální
+ * obsazená paměť patřila jen jemu.
+ *
+ * Použití: ./bench [počet klíčů]
+ */
+#define _GNU_SOURCE
+
+#include "ibst.h"
+#include "../btree.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+  // xorshift64
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+static void shuffle(int *keys, int count)
+{
+  for (int i = count - 1; i > 0; i--) {
+    int j = rng_next() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+}
+
+static void sum_visit(int key, int value, void *ctx)
+{
+  (*(long *)ctx) += key;
+}
+
+static void report(const char *tree, const char *op, double start, int count)
+{
+  printf("%-5s %-8s %8.1f ns/op\n", tree, op, (now_ns() - start) / count);
+}
+
+static void report_peak(const char *tree, int count, long checksum)
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  printf("%-5s %-8s %8.1f B/key (peak %ld kB, checksum %ld)\n", tree, "memory",
+         usage.ru_maxrss * 1024.0 / count, usage.ru_maxrss, checksum);
+}
+
+static void run_ibst(const int *keys, const int *probes, int count)
+{
+  long checksum = 0;
+  int value;
+  double start;
+  ibst_t tree;
+  ibst_init(&tree);
+
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    ibst_insert(&tree, keys[i], keys[i]);
+  }
+  report("ibst", "insert", start, count);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    checksum += ibst_search(&tree, probes[i], &value);
+  }
+  report("ibst", "search", start, count);
+  start = now_ns();
+  ibst_inorder(&tree, sum_visit, &checksum);
+  report("ibst", "inorder", start, count);
+  report_peak("ibst", count, checksum);
+  start = now_ns();
+  for (int i = 0; i < count / 2; i++) {
+    ibst_delete(&tree, keys[i]);
+  }
+  report("ibst", "delete", start, count / 2);
+  start = now_ns();
+  ibst_dispose(&tree);
+  report("ibst", "dispose", start, count - count / 2);
+}
+
+static void run_bst(const int *keys, const int *probes, int count)
+{
+  long checksum = 0;
+  bst_node_content_t *found;
+  double start;
+  bst_node_t *tree;
+  bst_init(&tree);
+
+  // the values are allocated, as they would be for real data
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    int *value = malloc(sizeof(int));
+    if (value == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    *value = keys[i];
+    bst_insert(&tree, keys[i], (bst_node_content_t){.value = value, .type = INTEGER});
+  }
+  report("bst", "insert", start, count);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    checksum += bst_search(tree, probes[i], &found);
+  }
+  report("bst", "search", start, count);
+  bst_items_t items;
+  bst_items_init(&items);
+  start = now_ns();
+  bst_inorder(tree, &items);
+  for (int i = 0; i < items.size; i++) {
+    checksum += items.nodes[i]->key;
+  }
+  report("bst", "inorder", start, count);
+  free(items.nodes);
+  report_peak("bst", count, checksum);
+  start = now_ns();
+  for (int i = 0; i < count / 2; i++) {
+    bst_delete(&tree, keys[i]);
+  }
+  report("bst", "delete", start, count / 2);
+  start = now_ns();
+  bst_dispose(&tree);
+  report("bst", "dispose", start, count - count / 2);
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int *keys = malloc(count * sizeof(int));
+  int *probes = malloc(count * sizeof(int));
+  if (keys == NULL || probes == NULL) {
+    return EXIT_FAILURE;
+  }
+  for (int i = 0; i < count; i++) {
+    keys[i] = i * 2; // even keys, odd probes miss
+    probes[i] = i;
+  }
+  shuffle(keys, count);
+  shuffle(probes, count);
+
+  printf("%d random keys, node %zu B (ibst) / %zu B + value (bst)\n\n", count,
+         sizeof(ibst_node_t), sizeof(bst_node_t));
+
+  void (*runs[])(const int *, const int *, int) = {run_ibst, run_bst};
+  for (int i = 0; i < 2; i++) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+      runs[i](keys, probes, count);
+      fflush(stdout);
+      _exit(EXIT_SUCCESS);
+    }
+    if (pid < 0) {
+      runs[i](keys, probes, count); // no separate peak memory, but still measured
+    }
+    else {
+      waitpid(pid, NULL, 0);
+    }
+    printf("\n");
+  }
+
+  free(keys);
+  free(probes);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * Kompaktní binární vyhledávací strom
+ *
+ * Funkce jsou iterativní. Vkládání nejdřív najde rodiče a až potom alokuje
+ * nový uzel, protože alokace může pole uzlů přesunout a ukazatele do něj
+ * by přestaly platit. Indexy zůstávají platné vždy.
+ */
+
+#include "ibst.h"
+#include <stdlib.h>
+
+/*
+ * Inicializace prázdného stromu.
+ */
+void ibst_init(ibst_t *tree)
+{
+  tree->nodes = NULL;
+  tree->capacity = 0;
+  tree->used = 0;
+  tree->count = 0;
+  tree->root = IBST_NONE;
+  tree->free = IBST_NONE;
+}
+
+/*
+ * Zvětší pole uzlů alespoň na capacity uzlů. Při známém počtu klíčů se tak
+ * pole nemusí zvětšovat během vkládání.
+ */
+void ibst_reserve(ibst_t *tree, uint32_t capacity)
+{
+  if (capacity <= tree->capacity) {
+    return;
+  }
+  ibst_node_t *nodes =
+      realloc(tree->nodes, (size_t)capacity * sizeof(ibst_node_t));
+  if (nodes == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  tree->nodes = nodes;
+  tree->capacity = capacity;
+}
+
+/*
+ * Pomocná funkce, která vrátí index uzlu pro vložení. Přednostně použije
+ * volný uzel, jinak další pozici pole (pole se případně zdvojnásobí).
+ */
+static uint32_t ibst_alloc(ibst_t *tree)
+{
+  if (tree->free != IBST_NONE) {
+    uint32_t index = tree->free;
+    tree->free = tree->nodes[index].right;
+    return index;
+  }
+  if (tree->used == tree->capacity) {
+    if (tree->capacity >= IBST_NONE / 2) {
+      if (tree->capacity == IBST_NONE - 1) {
+        exit(EXIT_FAILURE); // all indices are used
+      }
+      ibst_reserve(tree, IBST_NONE - 1);
+    }
+    else {
+      ibst_reserve(tree, tree->capacity > 0 ? tree->capacity * 2 : 16);
+    }
+  }
+  return tree->used++;
+}
+
+/*
+ * Vyhledání klíče ve stromu.
+ *
+ * V případě úspěchu vrátí funkce true a do value zapíše hodnotu uzlu. Jinak
+ * vrátí false a value zůstává nezměněná.
+ */
+bool ibst_search(const ibst_t *tree, int key, int *value)
+{
+  uint32_t index = tree->root;
+  while (index != IBST_NONE) {
+    const ibst_node_t *node = &tree->nodes[index];
+    if (key == node->key) {
+      *value = node->value;
+      return true;
+    }
+    index = key < node->key ? node->left : node->right;
+  }
+  return false;
+}
+
+/*
+ * Vložení dvojice klíč/hodnota. Pokud klíč už existuje, jeho hodnota je
+ * nahrazena.
+ */
+void ibst_insert(ibst_t *tree, int key, int value)
+{
+  uint32_t parent = IBST_NONE;
+  uint32_t index = tree->root;
+  while (index != IBST_NONE) {
+    ibst_node_t *node = &tree->nodes[index];
+    if (key == node->key) {
+      node->value = value;
+      return;
+    }
+    parent = index;
+    index = key < node->key ? node->left : node->right;
+  }
+
+  index = ibst_alloc(tree); // may move the array
+  tree->nodes[index] = (ibst_node_t){
+      .key = key, .value = value, .left = IBST_NONE, .right = IBST_NONE};
+  if (parent == IBST_NONE) {
+    tree->root = index;
+  }
+  else if (key < tree->nodes[parent].key) {
+    tree->nodes[parent].left = index;
+  }
+  else {
+    tree->nodes[parent].right = index;
+  }
+  tree->count++;
+}
+
+/*
+ * Odstranění uzlu s klíčem key.
+ *
+ * Uzel se dvěma potomky převezme klíč a hodnotu nejpravějšího uzlu levého
+ * podstromu a odstraní se ten (stejně jako bst_replace_by_rightmost).
+ * Odstraněný uzel se vloží do seznamu volných uzlů.
+ */
+void ibst_delete(ibst_t *tree, int key)
+{
+  // the array does not move here, pointers into it stay valid
+  uint32_t *link = &tree->root;
+  while (*link != IBST_NONE && tree->nodes[*link].key != key) {
+    ibst_node_t *node = &tree->nodes[*link];
+    link = key < node->key ? &node->left : &node->right;
+  }
+  if (*link == IBST_NONE) {
+    return;
+  }
+
+  uint32_t removed = *link;
+  ibst_node_t *node = &tree->nodes[removed];
+  if (node->left == IBST_NONE) {
+    *link = node->right;
+  }
+  else if (node->right == IBST_NONE) {
+    *link = node->left;
+  }
+  else {
+    uint32_t *rightmost = &node->left;
+    while (tree->nodes[*rightmost].right != IBST_NONE) {
+      rightmost = &tree->nodes[*rightmost].right;
+    }
+    removed = *rightmost;
+    node->key = tree->nodes[removed].key;
+    node->value = tree->nodes[removed].value;
+    *rightmost = tree->nodes[removed].left;
+  }
+
+  tree->nodes[removed].right = tree->free;
+  tree->free = removed;
+  tree->count--;
+}
+
+/*
+ * Zrušení celého stromu. Uzly nevlastní žádnou další paměť, stačí uvolnit
+ * pole. Strom je potom znovu prázdný.
+ */
+void ibst_dispose(ibst_t *tree)
+{
+  free(tree->nodes);
+  ibst_init(tree);
+}
+
+/*
+ * Inorder průchod stromem. Funkci visit zavolá pro každou dvojici
+ * klíč/hodnota ve vzestupném pořadí klíčů.
+ */
+void ibst_inorder(const ibst_t *tree, ibst_visit_t visit, void *ctx)
+{
+  int size = 0, capacity = 64;
+  uint32_t *stack = malloc(capacity * sizeof(uint32_t));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+
+  uint32_t index = tree->root;
+  while (true) {
+    while (index != IBST_NONE) { // go left
+      if (size == capacity) {
+        capacity *= 2;
+        uint32_t *grown = realloc(stack, capacity * sizeof(uint32_t));
+        if (grown == NULL) {
+          exit(EXIT_FAILURE); // error handling
+        }
+        stack = grown;
+      }
+      stack[size++] = index;
+      index = tree->nodes[index].left;
+    }
+    if (size == 0) {
+      break;
+    }
+    const ibst_node_t *node = &tree->nodes[stack[--size]];
+    visit(node->key, node->value, ctx);
+    index = node->right;
+  }
+  free(stack);
+}
@@ -0,0 +1,49 @@
+/*
+ * Hlavičkový soubor pro kompaktní binární vyhledávací strom.
+ *
+ * Všechny uzly leží v jednom rostoucím poli a potomci se odkazují 32bitovými
+ * indexy do tohoto pole místo ukazatelů. Hodnota typu int je uložená přímo
+ * v uzlu, uzel má proto 16 bajtů místo 40 (a bez samostatně alokované
+ * hodnoty). Uvolněné pozice se řetězí do seznamu volných uzlů a používají
+ * se znovu při dalším vkládání.
+ */
+
+#ifndef IAL_BTREE_COMPACT_H
+#define IAL_BTREE_COMPACT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Index chybějícího uzlu
+#define IBST_NONE UINT32_MAX
+
+// Uzel stromu
+typedef struct ibst_node {
+  int32_t key;      // klíč
+  int32_t value;    // hodnota
+  uint32_t left;    // index levého potomka nebo IBST_NONE
+  uint32_t right;   // index pravého potomka nebo IBST_NONE (volný uzel: další volný)
+} ibst_node_t;
+
+// Strom
+typedef struct ibst {
+  ibst_node_t *nodes;   // pole uzlů
+  uint32_t capacity;    // kapacita pole v počtu uzlů
+  uint32_t used;        // počet použitých pozic pole (včetně volných uzlů)
+  uint32_t count;       // počet uzlů ve stromu
+  uint32_t root;        // index kořene nebo IBST_NONE
+  uint32_t free;        // první volný uzel nebo IBST_NONE
+} ibst_t;
+
+// Funkce volaná pro každou dvojici klíč/hodnota při průchodu
+typedef void (*ibst_visit_t)(int key, int value, void *ctx);
+
+void ibst_init(ibst_t *tree);
+void ibst_reserve(ibst_t *tree, uint32_t capacity);
+bool ibst_search(const ibst_t *tree, int key, int *value);
+void ibst_insert(ibst_t *tree, int key, int value);
+void ibst_delete(ibst_t *tree, int key);
+void ibst_dispose(ibst_t *tree);
+void ibst_inorder(const ibst_t *tree, ibst_visit_t visit, void *ctx);
+
+#endif
@@ -0,0 +1,169 @@
+#include "ibst.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  void NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    ibst_t test_tree;                                                          \
+    ibst_init(&test_tree);
+
+#define ENDTEST                                                                \
+  printf("\n");                                                                \
+  ibst_dispose(&test_tree);                                                    \
+  }
+
+const int many_count = 1000;
+
+/*
+ * Ověří uspořádání klíčů a počet uzlů podstromu, vrátí počet uzlů nebo -1
+ * při porušení.
+ */
+long ibst_check(const ibst_t *tree, uint32_t index, long low, long high)
+{
+  if (index == IBST_NONE) {
+    return 0;
+  }
+  if (index >= tree->used) {
+    return -1;
+  }
+  const ibst_node_t *node = &tree->nodes[index];
+  if (node->key <= low || node->key >= high) {
+    return -1;
+  }
+  long left = ibst_check(tree, node->left, low, node->key);
+  long right = ibst_check(tree, node->right, node->key, high);
+  return left < 0 || right < 0 ? -1 : left + right + 1;
+}
+
+void ibst_print_check(const ibst_t *tree)
+{
+  long count = ibst_check(tree, tree->root, (long)INT_MIN - 1, (long)INT_MAX + 1);
+  if (count < 0 || count != tree->count) {
+    printf("Invariants violated\n");
+  }
+  else {
+    printf("Invariants hold, %ld nodes in %u slots\n", count, tree->used);
+  }
+}
+
+void print_visit(int key, int value, void *ctx)
+{
+  printf("[%d,%d]", key, value);
+}
+
+void count_visit(int key, int value, void *ctx)
+{
+  int *state = ctx; // state[0] = count, state[1] = previous key, state[2] = order ok
+  if (state[0] > 0 && key <= state[1]) {
+    state[2] = 0;
+  }
+  state[0]++;
+  state[1] = key;
+}
+
+void print_scan(const ibst_t *tree)
+{
+  int state[3] = {0, 0, 1};
+  ibst_inorder(tree, count_visit, state);
+  printf("Scanned %d keys, %s\n", state[0], state[2] ? "ascending" : "NOT ascending");
+}
+
+void print_search(const ibst_t *tree, int key)
+{
+  int value;
+  if (ibst_search(tree, key, &value)) {
+    printf("Search %d: %d\n", key, value);
+  }
+  else {
+    printf("Search %d: not found\n", key);
+  }
+}
+
+void insert_shuffled(ibst_t *tree, int count)
+{
+  // 7919 is prime, multiplying by it permutes 0..count-1 unless count is its multiple
+  for (int i = 0; i < count; i++) {
+    int key = (i * 7919) % count;
+    ibst_insert(tree, key, key * 10);
+  }
+}
+
+TEST(test_ibst_empty, "Search and delete in an empty tree")
+print_search(&test_tree, 1);
+ibst_delete(&test_tree, 1);
+ibst_print_check(&test_tree);
+printf("Node size: %zu bytes\n", sizeof(ibst_node_t));
+ENDTEST
+
+TEST(test_ibst_insert, "Insert, update and search a few keys")
+ibst_insert(&test_tree, 5, 50);
+ibst_insert(&test_tree, 1, 10);
+ibst_insert(&test_tree, 8, 80);
+ibst_insert(&test_tree, 3, 30);
+ibst_insert(&test_tree, 5, 55);
+ibst_inorder(&test_tree, print_visit, NULL);
+printf("\n");
+print_search(&test_tree, 3);
+print_search(&test_tree, 5);
+print_search(&test_tree, 4);
+ibst_print_check(&test_tree);
+ENDTEST
+
+TEST(test_ibst_delete, "Delete a leaf, a node with one child and with two children")
+int keys[] = {50, 30, 70, 20, 40, 60, 80, 35, 45};
+for (int i = 0; i < 9; i++) {
+  ibst_insert(&test_tree, keys[i], keys[i]);
+}
+ibst_delete(&test_tree, 20);
+ibst_delete(&test_tree, 60);
+ibst_delete(&test_tree, 50);
+ibst_delete(&test_tree, 99);
+ibst_inorder(&test_tree, print_visit, NULL);
+printf("\n");
+printf("Root: %d\n", test_tree.nodes[test_tree.root].key);
+ibst_print_check(&test_tree);
+ENDTEST
+
+TEST(test_ibst_reuse, "Deleted slots are reused by later inserts")
+insert_shuffled(&test_tree, many_count);
+for (int i = 0; i < many_count; i += 2) {
+  ibst_delete(&test_tree, i);
+}
+ibst_print_check(&test_tree);
+for (int i = 0; i < many_count / 2; i++) {
+  ibst_insert(&test_tree, many_count + i, i);
+}
+ibst_print_check(&test_tree);
+print_scan(&test_tree);
+ENDTEST
+
+TEST(test_ibst_many, "Insert and delete many keys")
+ibst_reserve(&test_tree, many_count);
+insert_shuffled(&test_tree, many_count);
+ibst_print_check(&test_tree);
+print_scan(&test_tree);
+print_search(&test_tree, 0);
+print_search(&test_tree, 517);
+print_search(&test_tree, many_count);
+for (int i = many_count - 1; i >= 0; i--) {
+  ibst_delete(&test_tree, i);
+}
+ibst_print_check(&test_tree);
+ENDTEST
+
+int main(int argc, char *argv[])
+{
+  printf("Compact Binary Search Tree - testing script\n");
+  printf("-------------------------------------------\n");
+  printf("\n");
+
+  test_ibst_empty();
+  test_ibst_insert();
+  test_ibst_delete();
+  test_ibst_reuse();
+  test_ibst_many();
+  printf("\n");
+  return 0;
+}
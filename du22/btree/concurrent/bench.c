@@ -0,0 +1,168 @@
+/*
+ * Propustnost souběžného stromu proti iterativnímu binárnímu vyhledávacímu
+ * stromu chráněnému jedním zámkem pro čtení/zápis.
+ *
+ * Použití: ./bench [operací na vlákno]
+ */
+#define _POSIX_C_SOURCE 200112L
+
+#include "cbst.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define KEY_RANGE (1 << 16)
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t rng_next(uint64_t *state)
+{
+  // xorshift64
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+typedef struct {
+  cbst_t *cbst;
+  bst_node_t **bst;
+  pthread_rwlock_t *lock;
+  int reads;        // percentage of searches, the rest is split insert/delete
+  int operations;
+  uint64_t seed;
+  long hits;
+} worker_t;
+
+static void *cbst_worker(void *arg)
+{
+  worker_t *worker = arg;
+  cbst_thread_t *thread = cbst_thread_register(worker->cbst);
+  bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+  bst_node_content_t value;
+  uint64_t seed = worker->seed; // workers share cache lines, keep hot state local
+  long hits = 0;
+  for (int i = 0; i < worker->operations; i++) {
+    uint64_t r = rng_next(&seed);
+    int key = r % KEY_RANGE;
+    int op = (r >> 32) % 100;
+    if (op < worker->reads) {
+      hits += cbst_search(thread, key, &value);
+    } else if (op % 2 == 0) {
+      cbst_insert(thread, key, empty);
+    } else {
+      cbst_delete(thread, key);
+    }
+  }
+  cbst_thread_unregister(thread);
+  worker->hits = hits;
+  return NULL;
+}
+
+static void *rwlock_worker(void *arg)
+{
+  worker_t *worker = arg;
+  bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+  bst_node_content_t *value;
+  uint64_t seed = worker->seed;
+  long hits = 0;
+  for (int i = 0; i < worker->operations; i++) {
+    uint64_t r = rng_next(&seed);
+    int key = r % KEY_RANGE;
+    int op = (r >> 32) % 100;
+    if (op < worker->reads) {
+      pthread_rwlock_rdlock(worker->lock);
+      hits += bst_search(*worker->bst, key, &value);
+      pthread_rwlock_unlock(worker->lock);
+    } else {
+      pthread_rwlock_wrlock(worker->lock);
+      if (op % 2 == 0) {
+        bst_insert(worker->bst, key, empty);
+      } else {
+        bst_delete(worker->bst, key);
+      }
+      pthread_rwlock_unlock(worker->lock);
+    }
+  }
+  worker->hits = hits;
+  return NULL;
+}
+
+/*
+ * Spustí threads vláken nad předvyplněným stromem a vrátí miliony operací
+ * za sekundu.
+ */
+static double run(void *(*function)(void *), cbst_t *cbst, bst_node_t **bst,
+                  pthread_rwlock_t *lock, int threads, int reads,
+                  int operations)
+{
+  pthread_t ids[threads];
+  worker_t workers[threads];
+  for (int i = 0; i < threads; i++) {
+    workers[i] = (worker_t){.cbst = cbst, .bst = bst, .lock = lock,
+                            .reads = reads, .operations = operations,
+                            .seed = 0x9e3779b97f4a7c15ull * (i + 1), .hits = 0};
+  }
+  double start = now_ns();
+  for (int i = 0; i < threads; i++) {
+    pthread_create(&ids[i], NULL, function, &workers[i]);
+  }
+  for (int i = 0; i < threads; i++) {
+    pthread_join(ids[i], NULL);
+  }
+  return (double)threads * operations * 1e3 / (now_ns() - start);
+}
+
+int main(int argc, char *argv[])
+{
+  int operations = argc > 1 ? atoi(argv[1]) : 200000;
+  if (operations <= 0) {
+    fprintf(stderr, "usage: %s [operations per thread]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const int thread_counts[] = {1, 2, 4, 8};
+  const int read_mixes[] = {100, 90, 50};
+  bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+  uint64_t seed = 42;
+
+  printf("%d keys, %d operations per thread, Mops/s\n\n", KEY_RANGE,
+         operations);
+  printf("%-7s %-7s %10s %10s\n", "reads", "threads", "cbst", "rwlock");
+  for (int m = 0; m < 3; m++) {
+    for (int t = 0; t < 4; t++) {
+      // both trees start from the same half-full key set
+      cbst_t cbst;
+      cbst_init(&cbst);
+      cbst_thread_t *thread = cbst_thread_register(&cbst);
+      bst_node_t *bst;
+      bst_init(&bst);
+      for (int i = 0; i < KEY_RANGE / 2; i++) {
+        int key = rng_next(&seed) % KEY_RANGE;
+        cbst_insert(thread, key, empty);
+        bst_insert(&bst, key, empty);
+      }
+      cbst_thread_unregister(thread);
+      pthread_rwlock_t lock;
+      pthread_rwlock_init(&lock, NULL);
+
+      double concurrent = run(cbst_worker, &cbst, NULL, NULL, thread_counts[t],
+                              read_mixes[m], operations);
+      double locked = run(rwlock_worker, NULL, &bst, &lock, thread_counts[t],
+                          read_mixes[m], operations);
+      printf("%3d%%    %-7d %10.2f %10.2f\n", read_mixes[m], thread_counts[t],
+             concurrent, locked);
+
+      pthread_rwlock_destroy(&lock);
+      bst_dispose(&bst);
+      cbst_dispose(&cbst);
+    }
+  }
+  return EXIT_SUCCESS;
+}
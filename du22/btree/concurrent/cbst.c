@@ -0,0 +1,464 @@
+/*
+ * Souběžný binární vyhledávací strom
+ *
+ * Listově orientovaný strom: vnitřní uzel s klíčem K posílá menší klíče
+ * doleva a ostatní doprava, dvojice klíč/hodnota jsou uložené v listech.
+ * Vnitřní uzly i listy se po zapojení do stromu už nemění (kromě ukazatelů
+ * na potomky), takže čtenář může strom procházet bez zámků a bez zápisů do
+ * sdílené paměti. Vložení nahradí list novým vnitřním uzlem se dvěma listy,
+ * odstranění přepojí prarodiče listu na jeho sourozence. Obojí je jediný
+ * atomický zápis ukazatele, který se provede pod zámky dotčených uzlů
+ * až po ověření, že se jejich okolí od vyhledání nezměnilo.
+ *
+ * Kořenem je zarážka, jejíž levý podstrom obsahuje celý strom. Nejlevějším
+ * listem je vždy zarážka, která se chová jako -nekonečno, takže každý list
+ * s klíčem má rodiče i prarodiče a odstranění nepotřebuje zvláštní případy.
+ */
+
+#include "cbst.h"
+#include <sched.h>
+#include <stdlib.h>
+
+/*
+ * Alokace uzlu.
+ */
+static cbst_node_t *cbst_node_create(int key, bst_node_content_t content,
+                                     bool leaf, bool sentinel)
+{
+  cbst_node_t *node = malloc(sizeof(cbst_node_t));
+  if (node == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  node->key = key;
+  node->content = content;
+  atomic_init(&node->left, NULL);
+  atomic_init(&node->right, NULL);
+  atomic_flag_clear(&node->lock);
+  atomic_init(&node->removed, false);
+  node->leaf = leaf;
+  node->sentinel = sentinel;
+  return node;
+}
+
+/*
+ * Uvolnění uzlu i s hodnotou listu.
+ */
+static void cbst_node_free(cbst_node_t *node)
+{
+  if (node->leaf && !node->sentinel) {
+    free(node->content.value);
+  }
+  free(node);
+}
+
+static void cbst_lock(cbst_node_t *node)
+{
+  while (atomic_flag_test_and_set_explicit(&node->lock, memory_order_acquire)) {
+    sched_yield();
+  }
+}
+
+static void cbst_unlock(cbst_node_t *node)
+{
+  atomic_flag_clear_explicit(&node->lock, memory_order_release);
+}
+
+/*
+ * Ukazatel na potomka, kterým pokračuje hledání klíče key.
+ */
+static _Atomic(cbst_node_t *) *cbst_child(cbst_node_t *node, int key)
+{
+  return node->sentinel || key < node->key ? &node->left : &node->right;
+}
+
+/*
+ * Inicializace stromu.
+ */
+void cbst_init(cbst_t *tree)
+{
+  bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+  tree->head = cbst_node_create(0, empty, false, true);
+  atomic_init(&tree->head->left, cbst_node_create(0, empty, true, true));
+  atomic_init(&tree->epoch, 2);
+  for (int i = 0; i < CBST_MAX_THREADS; i++) {
+    atomic_init(&tree->slots[i].epoch, 0);
+    atomic_init(&tree->slots[i].active, false);
+    atomic_init(&tree->slots[i].used, false);
+  }
+}
+
+/*
+ * Zrušení stromu.
+ *
+ * Se stromem už nesmí pracovat žádné vlákno a všechna vlákna musí být
+ * odregistrovaná.
+ */
+void cbst_dispose(cbst_t *tree)
+{
+  if (tree->head == NULL) {
+    return;
+  }
+  int size = 0, capacity = 64;
+  cbst_node_t **stack = malloc(capacity * sizeof(cbst_node_t *));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  stack[size++] = tree->head;
+  while (size > 0) {
+    cbst_node_t *node = stack[--size];
+    cbst_node_t *children[2] = {atomic_load(&node->left),
+                                atomic_load(&node->right)};
+    for (int i = 0; i < 2; i++) {
+      if (children[i] == NULL) {
+        continue;
+      }
+      if (size == capacity) {
+        capacity *= 2;
+        cbst_node_t **grown = realloc(stack, capacity * sizeof(cbst_node_t *));
+        if (grown == NULL) {
+          exit(EXIT_FAILURE);
+        }
+        stack = grown;
+      }
+      stack[size++] = children[i];
+    }
+    cbst_node_free(node);
+  }
+  free(stack);
+  tree->head = NULL;
+}
+
+/*
+ * Uvolní odložené uzly označené epochou nejvýše epoch - 2.
+ */
+static void cbst_reclaim(cbst_thread_t *thread, unsigned long epoch)
+{
+  for (int i = 0; i < 3; i++) {
+    cbst_limbo_t *limbo = &thread->limbo[i];
+    if (limbo->size > 0 && limbo->epoch + 2 <= epoch) {
+      for (int j = 0; j < limbo->size; j++) {
+        cbst_node_free(limbo->nodes[j]);
+      }
+      limbo->size = 0;
+    }
+  }
+}
+
+/*
+ * Posune globální epochu, pokud všechna aktivní vlákna už vstoupila
+ * v té současné.
+ */
+static void cbst_try_advance(cbst_t *tree)
+{
+  unsigned long epoch = atomic_load(&tree->epoch);
+  for (int i = 0; i < CBST_MAX_THREADS; i++) {
+    cbst_slot_t *slot = &tree->slots[i];
+    if (atomic_load(&slot->active) && atomic_load(&slot->epoch) != epoch) {
+      return;
+    }
+  }
+  atomic_compare_exchange_strong(&tree->epoch, &epoch, epoch + 1);
+}
+
+/*
+ * Registrace vlákna, které bude se stromem pracovat.
+ *
+ * Každé vlákno potřebuje vlastní kontext. Při vyčerpání CBST_MAX_THREADS
+ * záznamů vrací NULL.
+ */
+cbst_thread_t *cbst_thread_register(cbst_t *tree)
+{
+  for (int i = 0; i < CBST_MAX_THREADS; i++) {
+    bool expected = false;
+    if (!atomic_compare_exchange_strong(&tree->slots[i].used, &expected,
+                                        true)) {
+      continue;
+    }
+    cbst_thread_t *thread = malloc(sizeof(cbst_thread_t));
+    if (thread == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    thread->tree = tree;
+    thread->slot = &tree->slots[i];
+    thread->depth = 0;
+    thread->retired = 0;
+    for (int j = 0; j < 3; j++) {
+      thread->limbo[j].epoch = 0;
+      thread->limbo[j].nodes = NULL;
+      thread->limbo[j].size = 0;
+      thread->limbo[j].capacity = 0;
+    }
+    return thread;
+  }
+  return NULL;
+}
+
+/*
+ * Odregistrace vlákna.
+ *
+ * Počká, až bude možné uvolnit všechny uzly, které vlákno odpojilo.
+ */
+void cbst_thread_unregister(cbst_thread_t *thread)
+{
+  cbst_t *tree = thread->tree;
+  for (;;) {
+    cbst_reclaim(thread, atomic_load(&tree->epoch));
+    if (thread->limbo[0].size == 0 && thread->limbo[1].size == 0 &&
+        thread->limbo[2].size == 0) {
+      break;
+    }
+    cbst_try_advance(tree);
+    sched_yield();
+  }
+  for (int i = 0; i < 3; i++) {
+    free(thread->limbo[i].nodes);
+  }
+  atomic_store(&thread->slot->used, false);
+  free(thread);
+}
+
+/*
+ * Vstup do stromu.
+ *
+ * Dokud vlákno nezavolá odpovídající cbst_exit, žádný uzel ani hodnota,
+ * kterou ve stromu vidělo, nebude uvolněna. Volání lze vnořovat.
+ */
+void cbst_enter(cbst_thread_t *thread)
+{
+  if (thread->depth++ > 0) {
+    return;
+  }
+  cbst_slot_t *slot = thread->slot;
+  atomic_store(&slot->active, true);
+  // the epoch is re-read until it is stable, so a concurrent advance cannot
+  // skip over this thread
+  unsigned long epoch = atomic_load(&thread->tree->epoch);
+  for (;;) {
+    atomic_store(&slot->epoch, epoch);
+    unsigned long current = atomic_load(&thread->tree->epoch);
+    if (current == epoch) {
+      break;
+    }
+    epoch = current;
+  }
+  cbst_reclaim(thread, epoch);
+}
+
+/*
+ * Opuštění stromu.
+ */
+void cbst_exit(cbst_thread_t *thread)
+{
+  if (--thread->depth > 0) {
+    return;
+  }
+  atomic_store(&thread->slot->active, false);
+  if (thread->retired >= CBST_RETIRE_BATCH) {
+    thread->retired = 0;
+    cbst_try_advance(thread->tree);
+  }
+}
+
+/*
+ * Odloží odpojený uzel do uvolnění v pozdější epoše.
+ *
+ * Uzel se označí globální epochou přečtenou až po odpojení: každé vlákno,
+ * které ho mohlo vidět, vstoupilo nejpozději v ní, a epocha se o dvě dál
+ * posune až po jeho odchodu.
+ */
+static void cbst_retire(cbst_thread_t *thread, cbst_node_t *node)
+{
+  unsigned long epoch = atomic_load(&thread->tree->epoch);
+  cbst_limbo_t *limbo = &thread->limbo[epoch % 3];
+  if (limbo->epoch != epoch) {
+    // older than epoch - 2, nobody can reach these anymore
+    for (int i = 0; i < limbo->size; i++) {
+      cbst_node_free(limbo->nodes[i]);
+    }
+    limbo->size = 0;
+    limbo->epoch = epoch;
+  }
+  if (limbo->size == limbo->capacity) {
+    limbo->capacity = limbo->capacity == 0 ? 16 : 2 * limbo->capacity;
+    cbst_node_t **grown =
+        realloc(limbo->nodes, limbo->capacity * sizeof(cbst_node_t *));
+    if (grown == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    limbo->nodes = grown;
+  }
+  limbo->nodes[limbo->size++] = node;
+  thread->retired++;
+}
+
+/*
+ * Dohledání listu pro klíč spolu s jeho rodičem a prarodičem.
+ */
+static cbst_node_t *cbst_find(cbst_t *tree, int key, cbst_node_t **parent,
+                              cbst_node_t **grandparent)
+{
+  cbst_node_t *gp = NULL;
+  cbst_node_t *p = tree->head;
+  cbst_node_t *node = atomic_load_explicit(&p->left, memory_order_acquire);
+  while (!node->leaf) {
+    gp = p;
+    p = node;
+    node = atomic_load_explicit(cbst_child(node, key), memory_order_acquire);
+  }
+  *parent = p;
+  *grandparent = gp;
+  return node;
+}
+
+/*
+ * Vyhledání uzlu ve stromu.
+ *
+ * Funkce nebere žádné zámky. Hodnota zkopírovaná do value zůstává platná,
+ * dokud je vlákno ve stromu (cbst_enter); mimo něj ji může souběžné
+ * odstranění uvolnit.
+ */
+bool cbst_search(cbst_thread_t *thread, int key, bst_node_content_t *value)
+{
+  cbst_enter(thread);
+  cbst_node_t *parent, *grandparent;
+  cbst_node_t *leaf = cbst_find(thread->tree, key, &parent, &grandparent);
+  bool found = !leaf->sentinel && leaf->key == key;
+  if (found) {
+    *value = leaf->content;
+  }
+  cbst_exit(thread);
+  return found;
+}
+
+/*
+ * Vložení uzlu do stromu.
+ *
+ * Pokud uzel se zadaným klíčem už ve stromu existuje, nahradí se jeho hodnota
+ * (stará hodnota se uvolní až ji nikdo nemůže číst). Strom přebírá vlastnictví
+ * hodnoty.
+ */
+void cbst_insert(cbst_thread_t *thread, int key, bst_node_content_t value)
+{
+  cbst_enter(thread);
+  for (;;) {
+    cbst_node_t *parent, *grandparent;
+    cbst_node_t *leaf = cbst_find(thread->tree, key, &parent, &grandparent);
+    _Atomic(cbst_node_t *) *link = cbst_child(parent, key);
+
+    cbst_lock(parent);
+    if (atomic_load(&parent->removed) || atomic_load(link) != leaf) {
+      // someone changed the neighbourhood since the search, try again
+      cbst_unlock(parent);
+      continue;
+    }
+
+    cbst_node_t *fresh = cbst_node_create(key, value, true, false);
+    bool replace = !leaf->sentinel && leaf->key == key;
+    if (replace) {
+      atomic_store(&leaf->removed, true);
+      atomic_store_explicit(link, fresh, memory_order_release);
+    } else {
+      // the new routing node sends the smaller of the two keys left; the
+      // sentinel leaf acts as -infinity
+      bool smaller = leaf->sentinel || leaf->key < key;
+      int routing = smaller ? key : leaf->key;
+      bst_node_content_t empty = {.value = NULL, .type = INTEGER};
+      cbst_node_t *internal = cbst_node_create(routing, empty, false, false);
+      atomic_init(&internal->left, smaller ? leaf : fresh);
+      atomic_init(&internal->right, smaller ? fresh : leaf);
+      atomic_store_explicit(link, internal, memory_order_release);
+    }
+    cbst_unlock(parent);
+    if (replace) {
+      cbst_retire(thread, leaf);
+    }
+    break;
+  }
+  cbst_exit(thread);
+}
+
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Vrací true, pokud byl uzel se zadaným klíčem nalezen a odstraněn.
+ */
+bool cbst_delete(cbst_thread_t *thread, int key)
+{
+  bool deleted = false;
+  cbst_enter(thread);
+  for (;;) {
+    cbst_node_t *parent, *grandparent;
+    cbst_node_t *leaf = cbst_find(thread->tree, key, &parent, &grandparent);
+    if (leaf->sentinel || leaf->key != key) {
+      break;
+    }
+    _Atomic(cbst_node_t *) *up = cbst_child(grandparent, key);
+    _Atomic(cbst_node_t *) *down = cbst_child(parent, key);
+
+    // ancestors are always locked first, so two writers cannot deadlock
+    cbst_lock(grandparent);
+    cbst_lock(parent);
+    if (atomic_load(&grandparent->removed) || atomic_load(&parent->removed) ||
+        atomic_load(up) != parent || atomic_load(down) != leaf) {
+      cbst_unlock(parent);
+      cbst_unlock(grandparent);
+      continue;
+    }
+    cbst_node_t *sibling =
+        atomic_load(down == &parent->left ? &parent->right : &parent->left);
+    atomic_store(&parent->removed, true);
+    atomic_store(&leaf->removed, true);
+    atomic_store_explicit(up, sibling, memory_order_release);
+    cbst_unlock(parent);
+    cbst_unlock(grandparent);
+
+    cbst_retire(thread, parent);
+    cbst_retire(thread, leaf);
+    deleted = true;
+    break;
+  }
+  cbst_exit(thread);
+  return deleted;
+}
+
+/*
+ * Inorder průchod stromem.
+ *
+ * Průchod nebere zámky a souběžně se stromem může pracovat kdokoli; navštíví
+ * každý klíč, který ve stromu zůstal po celou dobu průchodu, klíče vložené
+ * nebo odstraněné během průchodu navštívit může, ale nemusí.
+ */
+void cbst_inorder(cbst_thread_t *thread, cbst_visit_t visit, void *ctx)
+{
+  cbst_enter(thread);
+  int size = 0, capacity = 64;
+  cbst_node_t **stack = malloc(capacity * sizeof(cbst_node_t *));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  cbst_node_t *node = atomic_load_explicit(&thread->tree->head->left,
+                                           memory_order_acquire);
+  for (;;) {
+    while (!node->leaf) {
+      if (size == capacity) {
+        capacity *= 2;
+        cbst_node_t **grown = realloc(stack, capacity * sizeof(cbst_node_t *));
+        if (grown == NULL) {
+          exit(EXIT_FAILURE);
+        }
+        stack = grown;
+      }
+      stack[size++] = node;
+      node = atomic_load_explicit(&node->left, memory_order_acquire);
+    }
+    if (!node->sentinel) {
+      visit(node->key, &node->content, ctx);
+    }
+    if (size == 0) {
+      break;
+    }
+    node = atomic_load_explicit(&stack[--size]->right, memory_order_acquire);
+  }
+  free(stack);
+  cbst_exit(thread);
+}
@@ -0,0 +1,85 @@
+/*
+ * Hlavičkový soubor pro souběžný binární vyhledávací strom.
+ *
+ * Strom je listově orientovaný: dvojice klíč/hodnota jsou jen v listech,
+ * vnitřní uzly slouží ke směrování. Vyhledávání neberou žádné zámky, změny
+ * zamknou nejvýše dva uzly (rodiče a prarodiče listu) a před zápisem ověří,
+ * že se jejich okolí mezitím nezměnilo. Odstraněné uzly se uvolňují až ve
+ * chvíli, kdy je žádné vlákno nemůže číst (epochy).
+ */
+
+#ifndef IAL_BTREE_CONCURRENT_H
+#define IAL_BTREE_CONCURRENT_H
+
+#include "../btree.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Maximální počet současně registrovaných vláken
+#define CBST_MAX_THREADS 64
+
+// Počet odložených uzlů, po kterém se vlákno pokusí posunout epochu
+#define CBST_RETIRE_BATCH 64
+
+// Uzel stromu (stejné uspořádání jako bst_node_t, navíc synchronizace)
+typedef struct cbst_node {
+  int key;                           // klíč
+  bst_node_content_t content;        // hodnota (jen v listech)
+  _Atomic(struct cbst_node *) left;  // levý potomek
+  _Atomic(struct cbst_node *) right; // pravý potomek
+  atomic_flag lock;                  // zámek pro změny potomků
+  atomic_bool removed;               // uzel byl odpojen ze stromu
+  bool leaf;                         // list s dvojicí klíč/hodnota
+  bool sentinel;                     // zarážka, nikdy neodpovídá klíči
+} cbst_node_t;
+
+// Záznam vlákna pro epochy
+typedef struct cbst_slot {
+  atomic_ulong epoch;   // epocha, ve které vlákno vstoupilo do stromu
+  atomic_bool active;   // vlákno právě pracuje se stromem
+  atomic_bool used;     // záznam patří registrovanému vláknu
+  char padding[64 - sizeof(atomic_ulong) - 2 * sizeof(atomic_bool)];
+} cbst_slot_t;
+
+// Strom
+typedef struct cbst {
+  cbst_node_t *head;                   // kořenová zarážka
+  atomic_ulong epoch;                  // globální epocha
+  cbst_slot_t slots[CBST_MAX_THREADS]; // záznamy vláken
+} cbst_t;
+
+// Odložené uzly jedné epochy
+typedef struct cbst_limbo {
+  unsigned long epoch;   // epocha, ve které byly uzly odpojeny
+  cbst_node_t **nodes;   // odložené uzly
+  int size;              // počet uzlů
+  int capacity;          // kapacita pole
+} cbst_limbo_t;
+
+// Kontext vlákna pracujícího se stromem
+typedef struct cbst_thread {
+  cbst_t *tree;          // strom
+  cbst_slot_t *slot;     // záznam vlákna
+  int depth;             // hloubka vnoření cbst_enter
+  int retired;           // odložené uzly od posledního pokusu o posun epochy
+  cbst_limbo_t limbo[3]; // odložené uzly posledních tří epoch
+} cbst_thread_t;
+
+// Funkce volaná pro každou dvojici klíč/hodnota při průchodu
+typedef void (*cbst_visit_t)(int key, bst_node_content_t *content, void *ctx);
+
+void cbst_init(cbst_t *tree);
+void cbst_dispose(cbst_t *tree);
+
+cbst_thread_t *cbst_thread_register(cbst_t *tree);
+void cbst_thread_unregister(cbst_thread_t *thread);
+
+void cbst_enter(cbst_thread_t *thread);
+void cbst_exit(cbst_thread_t *thread);
+
+bool cbst_search(cbst_thread_t *thread, int key, bst_node_content_t *value);
+void cbst_insert(cbst_thread_t *thread, int key, bst_node_content_t value);
+bool cbst_delete(cbst_thread_t *thread, int key);
+void cbst_inorder(cbst_thread_t *thread, cbst_visit_t visit, void *ctx);
+
+#endif
@@ -0,0 +1,217 @@
+#include "cbst.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  void NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    cbst_t test_tree;                                                          \
+    cbst_init(&test_tree);                                                     \
+    cbst_thread_t *test_thread = cbst_thread_register(&test_tree);
+
+#define ENDTEST                                                                \
+  printf("\n");                                                                \
+  cbst_thread_unregister(test_thread);                                         \
+  cbst_dispose(&test_tree);                                                    \
+  }
+
+#define THREADS 4
+const int per_thread = 20000;
+
+bst_node_content_t create_integer_content(int value)
+{
+  bst_node_content_t result = {
+    .type = INTEGER,
+    .value = malloc(sizeof(int))
+  };
+  *((int*)(result.value)) = value;
+  return result;
+}
+
+typedef struct {
+  int count;
+  int last;
+  bool sorted;
+  bool values;
+} check_t;
+
+void check_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  check_t *check = ctx;
+  if (check->count > 0 && key <= check->last) {
+    check->sorted = false;
+  }
+  if (*(int *)content->value != key * 10) {
+    check->values = false;
+  }
+  check->last = key;
+  check->count++;
+}
+
+void print_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  printf(" %d:%d", key, *(int *)content->value);
+}
+
+void print_check(cbst_thread_t *thread)
+{
+  check_t check = {.count = 0, .last = 0, .sorted = true, .values = true};
+  cbst_inorder(thread, check_visit, &check);
+  printf("count %d, sorted %s, values %s\n", check.count,
+         check.sorted ? "yes" : "no", check.values ? "yes" : "no");
+}
+
+void print_search(cbst_thread_t *thread, int key)
+{
+  bst_node_content_t value;
+  cbst_enter(thread);
+  if (cbst_search(thread, key, &value)) {
+    printf("search %d: %d\n", key, *(int *)value.value);
+  } else {
+    printf("search %d: not found\n", key);
+  }
+  cbst_exit(thread);
+}
+
+TEST(test_tree_basic, "Insert, search, update and delete from one thread")
+int keys[] = {5, 3, 8, -2, 4, 7, 9, 0};
+for (int i = 0; i < 8; i++) {
+  cbst_insert(test_thread, keys[i], create_integer_content(keys[i] * 10));
+}
+printf("inorder:");
+cbst_inorder(test_thread, print_visit, NULL);
+printf("\n");
+print_search(test_thread, 4);
+print_search(test_thread, 6);
+cbst_insert(test_thread, 4, create_integer_content(444));
+print_search(test_thread, 4);
+printf("delete 5: %s\n", cbst_delete(test_thread, 5) ? "yes" : "no");
+printf("delete 5: %s\n", cbst_delete(test_thread, 5) ? "yes" : "no");
+printf("delete -2: %s\n", cbst_delete(test_thread, -2) ? "yes" : "no");
+printf("inorder:");
+cbst_inorder(test_thread, print_visit, NULL);
+printf("\n");
+ENDTEST
+
+TEST(test_tree_empty, "Operations on an empty tree")
+print_search(test_thread, 1);
+printf("delete 1: %s\n", cbst_delete(test_thread, 1) ? "yes" : "no");
+print_check(test_thread);
+cbst_insert(test_thread, 1, create_integer_content(10));
+printf("delete 1: %s\n", cbst_delete(test_thread, 1) ? "yes" : "no");
+print_check(test_thread);
+ENDTEST
+
+/*
+ * Permutace 0..per_thread-1, aby se strom vkládáním nezdegeneroval do seznamu.
+ */
+int scatter(int i)
+{
+  return (int)((long)i * 7919 % per_thread);
+}
+
+typedef struct {
+  cbst_t *tree;
+  int id;
+  int found;
+} worker_t;
+
+void *insert_worker(void *arg)
+{
+  worker_t *worker = arg;
+  cbst_thread_t *thread = cbst_thread_register(worker->tree);
+  // interleave the key ranges so the threads collide on the same subtrees
+  for (int i = 0; i < per_thread; i++) {
+    int key = scatter(i) * THREADS + worker->id;
+    cbst_insert(thread, key, create_integer_content(key * 10));
+  }
+  cbst_thread_unregister(thread);
+  return NULL;
+}
+
+void *delete_worker(void *arg)
+{
+  worker_t *worker = arg;
+  cbst_thread_t *thread = cbst_thread_register(worker->tree);
+  for (int i = 0; i < per_thread; i++) {
+    int key = scatter(i) * THREADS + worker->id;
+    if (key % 2 == 1) {
+      cbst_delete(thread, key);
+    }
+  }
+  cbst_thread_unregister(thread);
+  return NULL;
+}
+
+void *search_worker(void *arg)
+{
+  worker_t *worker = arg;
+  cbst_thread_t *thread = cbst_thread_register(worker->tree);
+  bst_node_content_t value;
+  for (int i = 0; i < per_thread * THREADS; i += 2) {
+    // even keys are never deleted
+    cbst_enter(thread);
+    if (cbst_search(thread, i, &value) && *(int *)value.value == i * 10) {
+      worker->found++;
+    }
+    cbst_exit(thread);
+  }
+  cbst_thread_unregister(thread);
+  return NULL;
+}
+
+void run_workers(cbst_t *tree, void *(*function)(void *), worker_t *workers)
+{
+  pthread_t threads[THREADS];
+  for (int i = 0; i < THREADS; i++) {
+    workers[i] = (worker_t){.tree = tree, .id = i, .found = 0};
+    pthread_create(&threads[i], NULL, function, &workers[i]);
+  }
+  for (int i = 0; i < THREADS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+TEST(test_tree_concurrent_insert, "Insert interleaved keys from several threads")
+worker_t workers[THREADS];
+run_workers(&test_tree, insert_worker, workers);
+print_check(test_thread);
+ENDTEST
+
+TEST(test_tree_concurrent_mixed, "Delete odd keys while other threads search")
+worker_t workers[THREADS];
+run_workers(&test_tree, insert_worker, workers);
+
+pthread_t deleters[THREADS];
+worker_t delete_workers[THREADS];
+for (int i = 0; i < THREADS; i++) {
+  delete_workers[i] = (worker_t){.tree = &test_tree, .id = i, .found = 0};
+  pthread_create(&deleters[i], NULL, delete_worker, &delete_workers[i]);
+}
+run_workers(&test_tree, search_worker, workers);
+for (int i = 0; i < THREADS; i++) {
+  pthread_join(deleters[i], NULL);
+}
+
+int found = 0;
+for (int i = 0; i < THREADS; i++) {
+  found += workers[i].found;
+}
+printf("even keys found by searchers: %d of %d\n", found,
+       THREADS * per_thread * THREADS / 2);
+print_check(test_thread);
+ENDTEST
+
+int main(int argc, char *argv[])
+{
+  printf("Concurrent Binary Search Tree - testing script\n");
+  printf("----------------------------------------------\n");
+  printf("\n");
+  test_tree_basic();
+  test_tree_empty();
+  test_tree_concurrent_insert();
+  test_tree_concurrent_mixed();
+  printf("\n");
+  return 0;
+}
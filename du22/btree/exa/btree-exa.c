@@ -7,10 +7,286 @@
  * 
  */
 
-#include "../btree.h"
+#define _POSIX_C_SOURCE 200809L
+
+#include "btree-exa.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Třídy znaků: 0-25 jsou písmena a-z, potom mezera a ostatní znaky
+#define LETTER_SPACE 26
+#define LETTER_OTHER 27
+#define LETTER_ALL ((1u << LETTER_CLASSES) - 1)
+
+// Počet bajtů klasifikovaných najednou
+#if defined(__AVX2__)
+#define LETTER_BLOCK 32
+#elif defined(__SSE2__)
+#define LETTER_BLOCK 16
+#else
+#define LETTER_BLOCK 8
+#endif
+
+// Nejmenší úsek souboru, pro který se vyplatí spustit další vlákno
+#define LETTER_THREAD_MIN (1 << 20)
+
+/*
+ * Třída jednoho znaku (skalárně, pro konec vstupu).
+ */
+static unsigned char letter_class(unsigned char c) {
+    unsigned char index = (c | 0x20) - 'a'; // case fold, only letters end up in 0..25
+    if (index < 26) {
+        return index;
+    }
+    return c == ' ' ? LETTER_SPACE : LETTER_OTHER;
+}
+
+/*
+ * Klasifikace bloku LETTER_BLOCK bajtů do pole classes.
+ */
+static void letter_classify(const unsigned char *input, unsigned char *classes) {
+#if defined(__AVX2__)
+    __m256i block = _mm256_loadu_si256((const __m256i *)input);
+    __m256i index = _mm256_sub_epi8(_mm256_or_si256(block, _mm256_set1_epi8(0x20)),
+                                    _mm256_set1_epi8('a'));
+    // unsigned index <= 25, i.e. min(index, 25) == index
+    __m256i letter = _mm256_cmpeq_epi8(_mm256_min_epu8(index, _mm256_set1_epi8(25)), index);
+    __m256i space = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' '));
+    __m256i other = _mm256_add_epi8(_mm256_set1_epi8(LETTER_OTHER), space); // 26 for spaces
+    _mm256_storeu_si256((__m256i *)classes, _mm256_blendv_epi8(other, index, letter));
+#elif defined(__SSE2__)
+    __m128i block = _mm_loadu_si128((const __m128i *)input);
+    __m128i index = _mm_sub_epi8(_mm_or_si128(block, _mm_set1_epi8(0x20)),
+                                 _mm_set1_epi8('a'));
+    // unsigned index <= 25, i.e. min(index, 25) == index
+    __m128i letter = _mm_cmpeq_epi8(_mm_min_epu8(index, _mm_set1_epi8(25)), index);
+    __m128i space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    __m128i other = _mm_add_epi8(_mm_set1_epi8(LETTER_OTHER), space); // 26 for spaces
+    _mm_storeu_si128((__m128i *)classes,
+                     _mm_or_si128(_mm_and_si128(letter, index),
+                                  _mm_andnot_si128(letter, other)));
+#else
+    for (int i = 0; i < LETTER_BLOCK; i++) {
+        classes[i] = letter_class(input[i]);
+    }
+#endif
+}
+
+/*
+ * Zaznamená třídy, které se v bloku objevily poprvé.
+ */
+static void letter_note_first(letter_count_state_t *state,
+                              const unsigned char *classes, int count) {
+    for (int i = 0; i < count; i++) {
+        uint32_t bit = 1u << classes[i];
+        if (!(state->seen & bit)) {
+            state->seen |= bit;
+            state->order[state->order_count++] = classes[i];
+        }
+    }
+}
+
+/*
+ * Inicializace stavu počítání.
+ */
+void letter_count_init(letter_count_state_t *state) {
+    memset(state, 0, sizeof(*state));
+}
+
+/*
+ * Přičte do stavu length bajtů z buffer. Úsek nemusí končit nulovým znakem
+ * a nulový znak v něm se počítá jako ostatní znak ('_').
+ */
+void letter_count_feed(letter_count_state_t *state, const char *buffer,
+                       size_t length) {
+    const unsigned char *bytes = (const unsigned char *)buffer;
+    unsigned char classes[LETTER_BLOCK];
+    size_t index = 0;
+
+    for (; index + LETTER_BLOCK <= length; index += LETTER_BLOCK) {
+        letter_classify(bytes + index, classes);
+        if (state->seen != LETTER_ALL) { // stops once all classes appeared
+            letter_note_first(state, classes, LETTER_BLOCK);
+        }
+        for (int i = 0; i < LETTER_BLOCK; i += LETTER_TABLES) {
+            state->counts[0][classes[i]]++;
+            state->counts[1][classes[i + 1]]++;
+            state->counts[2][classes[i + 2]]++;
+            state->counts[3][classes[i + 3]]++;
+        }
+    }
+
+    // the rest of the input, shorter than a block
+    for (; index < length; index++) {
+        classes[0] = letter_class(bytes[index]);
+        letter_note_first(state, classes, 1);
+        state->counts[index % LETTER_TABLES][classes[0]]++;
+    }
+}
+
+static char letter_key(int class) {
+    return class < LETTER_SPACE ? 'a' + class : class == LETTER_SPACE ? ' ' : '_';
+}
+
+static int letter_class_of_key(char key) {
+    if (key >= 'a' && key <= 'z') {
+        return key - 'a';
+    }
+    return key == ' ' ? LETTER_SPACE : key == '_' ? LETTER_OTHER : -1;
+}
 
+/*
+ * Přičte ke stavu state stav next, který počítal vstup následující za
+ * vstupem state (na pořadí záleží kvůli pořadí prvních výskytů).
+ */
+void letter_count_merge(letter_count_state_t *state,
+                        const letter_count_state_t *next) {
+    for (int table = 0; table < LETTER_TABLES; table++) {
+        for (int class = 0; class < LETTER_CLASSES; class++) {
+            state->counts[table][class] += next->counts[table][class];
+        }
+    }
+    letter_note_first(state, next->order, next->order_count);
+}
+
+/*
+ * Přesný počet výskytů znaku key ('a'-'z', ' ' nebo '_').
+ */
+uint64_t letter_count_total(const letter_count_state_t *state, char key) {
+    int class = letter_class_of_key(key);
+    if (class < 0 || class >= LETTER_CLASSES) {
+        return 0;
+    }
+    uint64_t total = 0;
+    for (int table = 0; table < LETTER_TABLES; table++) {
+        total += state->counts[table][class];
+    }
+    return total;
+}
+
+/*
+ * Postaví ze stavu strom. Třídy se vkládají v pořadí prvního výskytu, strom
+ * má proto stejný tvar, jako kdyby se znaky vkládaly postupně. Hodnota uzlu
+ * je int, počty nad INT_MAX se v něm zastaví na INT_MAX (přesné počty vrací
+ * letter_count_total).
+ */
+void letter_count_finish(letter_count_state_t *state, bst_node_t **tree) {
+    bst_init(tree);
+    for (int i = 0; i < state->order_count; i++) {
+        char key = letter_key(state->order[i]);
+        uint64_t total = letter_count_total(state, key);
+
+        int *count = malloc(sizeof(int));
+        if (!count) {
+            exit(EXIT_FAILURE);
+        }
+        *count = total > INT_MAX ? INT_MAX : (int)total;
+
+        bst_node_content_t content = {.value = count, .type = INTEGER};
+        bst_insert(tree, key, content);
+    }
+}
+
+// Úsek souboru zpracovávaný jedním vláknem
+typedef struct letter_count_part {
+    const char *buffer;
+    size_t length;
+    letter_count_state_t state;
+    pthread_t thread;
+    bool started;     // true if the part runs on its own thread
+} letter_count_part_t;
+
+static void *letter_count_part_run(void *arg) {
+    letter_count_part_t *part = arg;
+    letter_count_feed(&part->state, part->buffer, part->length);
+    return NULL;
+}
+
+/*
+ * Spočítá znaky souboru path a výsledek uloží do stromu.
+ *
+ * Soubor se namapuje do paměti a rozdělí na threads souvislých úseků
+ * (při threads <= 0 podle počtu procesorů), každé vlákno počítá do vlastního
+ * stavu a stavy se na konci sečtou v pořadí úseků. Funkce vrací false, pokud
+ * soubor nejde otevřít nebo namapovat, strom je pak prázdný.
+ */
+bool letter_count_file(bst_node_t **tree, const char *path, int threads) {
+    bst_init(tree);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t length = st.st_size;
+    if (length == 0) { // nothing to map
+        close(fd);
+        return true;
+    }
+    const char *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    posix_madvise((void *)data, length, POSIX_MADV_SEQUENTIAL);
+
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? online : 1;
+    }
+    size_t most = length / LETTER_THREAD_MIN > 0 ? length / LETTER_THREAD_MIN : 1;
+    if ((size_t)threads > most) { // small files stay on fewer threads
+        threads = most;
+    }
+
+    letter_count_part_t *parts = malloc(threads * sizeof(letter_count_part_t));
+    if (!parts) {
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < threads; i++) {
+        size_t begin = length / threads * i;
+        size_t end = i == threads - 1 ? length : length / threads * (i + 1);
+        parts[i].buffer = data + begin;
+        parts[i].length = end - begin;
+        letter_count_init(&parts[i].state);
+    }
+    // part 0 runs on this thread, also when a thread cannot be created
+    for (int i = 1; i < threads; i++) {
+        parts[i].started = pthread_create(&parts[i].thread, NULL,
+                                          letter_count_part_run, &parts[i]) == 0;
+    }
+    letter_count_part_run(&parts[0]);
+    for (int i = 1; i < threads; i++) {
+        if (parts[i].started) {
+            pthread_join(parts[i].thread, NULL);
+        }
+        else {
+            letter_count_part_run(&parts[i]);
+        }
+    }
+    munmap((void *)data, length);
+
+    for (int i = 1; i < threads; i++) {
+        letter_count_merge(&parts[0].state, &parts[i].state);
+    }
+    letter_count_finish(&parts[0].state, tree);
+    free(parts);
+    return true;
+}
 
 /**
  * Vypočítání frekvence výskytů znaků ve vstupním řetězci.
@@ -31,65 +307,9 @@
  * Pro implementaci si můžete v tomto souboru nadefinovat vlastní pomocné funkce.
 */
 void letter_count(bst_node_t **tree, char *input) {
-    // init tree
-    bst_init(tree);
-
-    // go through each character in the input
-    for (int index = 0; input[index] != '\0'; index++) {
-        char current_char = input[index];
-        char norm_char;
-
-        // normalize the key to lowercase and handle special characters
-        if (current_char >= 'A' && current_char <= 'Z') {
-            char offset = 'a' - 'A'; // offset for converting to lowercase
-            norm_char = current_char + offset; // convert lowercase
-        }
-        else if (current_char >= 'a' && current_char <= 'z') { 
-            norm_char = current_char; 
-        }
-        else if (current_char == ' ') { // space
-            norm_char = ' ';
-        }
-        else {
-            norm_char = '_'; // other characters
-        }
-
-        bst_node_content_t *node_content = NULL;
-
-        // serach for the node
-        bool found_node = bst_search(*tree, norm_char, &node_content);
-
-        if (found_node && node_content != NULL) {
-            // if node exists, increment the count
-            if (node_content->value != NULL && node_content->type == INTEGER) {
-                (*(int *)(node_content->value)) += 1;
-            }
-            else {
-                // if the value is not an integer, set it to 1
-                int *new_count  = malloc(sizeof(int));
-                if (!new_count) {
-                    exit(EXIT_FAILURE); 
-                }
-                *new_count  = 1;
-                node_content->value = new_count;
-                node_content->type = INTEGER;
-            }
-        }
-        else {
-            // if the node does not exist, create a new one
-            int *count = malloc(sizeof(int));
-            if (!count) {
-                exit(EXIT_FAILURE);
-            }
-            *count = 1; 
-
-            // create new content
-            bst_node_content_t new_content_value;
-            new_content_value.type = INTEGER;
-            new_content_value.value = count;
-
-            // insert the new node
-            bst_insert(tree, norm_char, new_content_value);
-        }
-    }
-}
\ No newline at end of file
+    // count into a histogram first, the tree is built once at the end
+    letter_count_state_t state;
+    letter_count_init(&state);
+    letter_count_feed(&state, input, strlen(input));
+    letter_count_finish(&state, tree);
+}
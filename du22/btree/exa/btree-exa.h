@@ -0,0 +1,41 @@
+/*
+ * Hlavičkový soubor pro počítání znaků po částech a ze souboru.
+ *
+ * Stav letter_count_state_t drží histogram tříd znaků a pořadí jejich
+ * prvního výskytu. Vstup se do něj přidává libovolně dlouhými úseky
+ * (letter_count_feed), strom se postaví až na konci (letter_count_finish)
+ * a vypadá stejně, jako kdyby se celý vstup předal funkci letter_count.
+ */
+
+#ifndef IAL_BTREE_EXA_H
+#define IAL_BTREE_EXA_H
+
+#include "../btree.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Počet tříd znaků: a-z, mezera a ostatní znaky
+#define LETTER_CLASSES 28
+
+// Počet prokládaných tabulek čítačů (po sobě jdoucí bajty stejné třídy
+// nezvyšují stejný čítač, takže na sebe zápisy nečekají)
+#define LETTER_TABLES 4
+
+// Rozpracované počítání znaků
+typedef struct letter_count_state {
+  uint64_t counts[LETTER_TABLES][LETTER_CLASSES]; // prokládané čítače
+  uint32_t seen;                                  // maska tříd, které už se objevily
+  unsigned char order[LETTER_CLASSES];            // třídy v pořadí prvního výskytu
+  int order_count;                                // počet tříd v order
+} letter_count_state_t;
+
+void letter_count_init(letter_count_state_t *state);
+void letter_count_feed(letter_count_state_t *state, const char *buffer,
+                       size_t length);
+void letter_count_merge(letter_count_state_t *state,
+                        const letter_count_state_t *next);
+uint64_t letter_count_total(const letter_count_state_t *state, char key);
+void letter_count_finish(letter_count_state_t *state, bst_node_t **tree);
+bool letter_count_file(bst_node_t **tree, const char *path, int threads);
+
+#endif
@@ -0,0 +1,297 @@
+/*
+ * Počítání slov a n-gramů slov
+ *
+ * Buffer word obsahuje n - 1 předchozích slov, každé následované mezerou,
+ * a za nimi rozpracované slovo. Po dokončení slova je tedy celý buffer
+ * textem n-gramu a stačí ho jednou vyhledat v tabulce. Slovo rozdělené mezi
+ * dvě volání ngram_feed zůstává v bufferu, dokud nepřijde jeho konec.
+ */
+
+#include "ngram.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Velikost bloku areny
+#define NGRAM_BLOCK_SIZE (64 * 1024)
+
+// Počáteční velikost hašovací tabulky
+#define NGRAM_INITIAL_CAPACITY 1024
+
+/*
+ * Inicializace počítadla n-gramů o n slovech (n >= 1).
+ */
+void ngram_init(ngram_counter_t *counter, int n)
+{
+  counter->n = n > 0 ? n : 1;
+  counter->arena = NULL;
+  counter->capacity = NGRAM_INITIAL_CAPACITY;
+  counter->size = 0;
+  counter->entries = calloc(counter->capacity, sizeof(ngram_entry_t));
+  counter->word_capacity = 64;
+  counter->word = malloc(counter->word_capacity);
+  if (counter->entries == NULL || counter->word == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  counter->word_length = 0;
+  counter->prefix = 0;
+  counter->window = 0;
+  counter->sorted = NULL;
+  counter->sorted_size = 0;
+}
+
+// FNV-1a
+static uint32_t ngram_hash(const char *text, size_t length)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)text[i];
+    hash *= 0x100000001b3ull;
+  }
+  return (uint32_t)(hash ^ (hash >> 32));
+}
+
+/*
+ * Pomocná funkce pro uložení textu do areny. Texty se nikdy nepřesouvají,
+ * ukazatele na ně platí až do ngram_dispose.
+ */
+static const char *ngram_intern(ngram_counter_t *counter, const char *text,
+                                size_t length)
+{
+  ngram_block_t *block = counter->arena;
+  if (block == NULL || block->used + length + 1 > block->capacity) {
+    size_t capacity = length + 1 > NGRAM_BLOCK_SIZE ? length + 1 : NGRAM_BLOCK_SIZE;
+    block = malloc(sizeof(ngram_block_t) + capacity);
+    if (block == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    block->next = counter->arena;
+    block->used = 0;
+    block->capacity = capacity;
+    counter->arena = block;
+  }
+  char *copy = block->data + block->used;
+  memcpy(copy, text, length);
+  copy[length] = '\0';
+  block->used += length + 1;
+  return copy;
+}
+
+/*
+ * Pozice textu v tabulce: buď jeho položka, nebo volná položka, kam patří.
+ */
+static ngram_entry_t *ngram_find(const ngram_counter_t *counter, const char *text,
+                                 size_t length, uint32_t hash)
+{
+  size_t mask = counter->capacity - 1;
+  for (size_t index = hash & mask;; index = (index + 1) & mask) {
+    ngram_entry_t *entry = &counter->entries[index];
+    if (entry->token == NULL ||
+        (entry->hash == hash && entry->length == length &&
+         memcmp(entry->token, text, length) == 0)) {
+      return entry;
+    }
+  }
+}
+
+/*
+ * Zdvojnásobení tabulky. Texty zůstávají v areně, přesouvají se jen položky.
+ */
+static void ngram_grow(ngram_counter_t *counter)
+{
+  ngram_entry_t *old = counter->entries;
+  size_t old_capacity = counter->capacity;
+  counter->capacity *= 2;
+  counter->entries = calloc(counter->capacity, sizeof(ngram_entry_t));
+  if (counter->entries == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old[i].token != NULL) {
+      *ngram_find(counter, old[i].token, old[i].length, old[i].hash) = old[i];
+    }
+  }
+  free(old);
+}
+
+/*
+ * Započítá dokončené slovo na konci bufferu a posune okno předchozích slov.
+ */
+static void ngram_end_word(ngram_counter_t *counter)
+{
+  if (counter->window == counter->n - 1) {
+    uint32_t hash = ngram_hash(counter->word, counter->word_length);
+    ngram_entry_t *entry =
+        ngram_find(counter, counter->word, counter->word_length, hash);
+    if (entry->token == NULL) { // first occurrence
+      entry->token = ngram_intern(counter, counter->word, counter->word_length);
+      entry->length = counter->word_length;
+      entry->hash = hash;
+      entry->count = 0;
+      counter->size++;
+    }
+    entry->count++;
+    if (counter->size * 10 > counter->capacity * 7) {
+      ngram_grow(counter);
+    }
+  }
+
+  if (counter->n == 1) {
+    counter->word_length = 0;
+    return;
+  }
+  if (counter->window == counter->n - 1) { // drop the oldest word
+    size_t first =
+        (char *)memchr(counter->word, ' ', counter->word_length) + 1 - counter->word;
+    memmove(counter->word, counter->word + first, counter->word_length - first);
+    counter->word_length -= first;
+  }
+  else {
+    counter->window++;
+  }
+  counter->word[counter->word_length++] = ' '; // there is always room for it
+  counter->prefix = counter->word_length;
+}
+
+/*
+ * Přičte n-gramy z length bajtů textu text. Text nemusí končit nulou a slovo
+ * nebo n-gram může pokračovat v dalším volání.
+ */
+void ngram_feed(ngram_counter_t *counter, const char *text, size_t length)
+{
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = text[i];
+    bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c >= 0x80;
+    if (!letter) {
+      if (counter->word_length > counter->prefix) {
+        ngram_end_word(counter);
+      }
+      continue;
+    }
+
+    if (counter->word_length + 2 > counter->word_capacity) { // char and a space
+      counter->word_capacity *= 2;
+      char *word = realloc(counter->word, counter->word_capacity);
+      if (word == NULL) {
+        exit(EXIT_FAILURE); // error handling
+      }
+      counter->word = word;
+    }
+    counter->word[counter->word_length++] = c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+  }
+}
+
+/*
+ * Počet výskytů n-gramu token (slova oddělená jednou mezerou, malými písmeny).
+ */
+uint64_t ngram_count(const ngram_counter_t *counter, const char *token)
+{
+  size_t length = strlen(token);
+  ngram_entry_t *entry = ngram_find(counter, token, length, ngram_hash(token, length));
+  return entry->token != NULL ? entry->count : 0;
+}
+
+static int ngram_compare(const void *a, const void *b)
+{
+  return strcmp(((const ngram_entry_t *)a)->token, ((const ngram_entry_t *)b)->token);
+}
+
+/*
+ * Ukončí vstup (rozpracované slovo se započítá) a postaví vyvážený strom,
+ * jehož klíče jsou pořadí n-gramů v abecedním pořadí a hodnoty počty
+ * výskytů (nad INT_MAX se zastaví na INT_MAX). Strom se staví v O(n) funkcí
+ * bst_build_sorted. Klíče platí do dalšího volání ngram_build_tree.
+ */
+void ngram_build_tree(ngram_counter_t *counter, bst_node_t **tree)
+{
+  if (counter->word_length > counter->prefix) {
+    ngram_end_word(counter);
+  }
+
+  size_t count = counter->size;
+  ngram_entry_t *entries = malloc((count + 1) * sizeof(ngram_entry_t));
+  const char **sorted = realloc(counter->sorted, (count + 1) * sizeof(char *));
+  int *keys = malloc((count + 1) * sizeof(int));
+  bst_node_content_t *values = malloc((count + 1) * sizeof(bst_node_content_t));
+  if (entries == NULL || sorted == NULL || keys == NULL || values == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  counter->sorted = sorted;
+  counter->sorted_size = count;
+
+  size_t used = 0;
+  for (size_t i = 0; i < counter->capacity; i++) {
+    if (counter->entries[i].token != NULL) {
+      entries[used++] = counter->entries[i];
+    }
+  }
+  qsort(entries, count, sizeof(ngram_entry_t), ngram_compare);
+
+  for (size_t i = 0; i < count; i++) {
+    int *value = malloc(sizeof(int));
+    if (value == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    *value = entries[i].count > INT32_MAX ? INT32_MAX : (int)entries[i].count;
+    sorted[i] = entries[i].token;
+    keys[i] = i;
+    values[i] = (bst_node_content_t){.value = value, .type = INTEGER};
+  }
+  bst_build_sorted(tree, keys, values, count);
+  free(entries);
+  free(keys);
+  free(values);
+}
+
+/*
+ * Text n-gramu s klíčem key ze stromu posledního ngram_build_tree, nebo NULL.
+ */
+const char *ngram_token(const ngram_counter_t *counter, int key)
+{
+  if (key < 0 || (size_t)key >= counter->sorted_size) {
+    return NULL;
+  }
+  return counter->sorted[key];
+}
+
+/*
+ * Klíč prvního n-gramu, který je v abecedním pořadí větší nebo roven token
+ * (počet n-gramů, pokud takový není). Pro předponu p vrací
+ * bst_range(tree, ngram_key(p), ngram_key(p s posledním znakem o jedna
+ * větším), ...) všechny n-gramy začínající na p.
+ */
+int ngram_key(const ngram_counter_t *counter, const char *token)
+{
+  size_t low = 0, high = counter->sorted_size;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (strcmp(counter->sorted[middle], token) < 0) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/*
+ * Uvolnění počítadla včetně všech textů. Strom z ngram_build_tree je
+ * samostatný a ruší se funkcí bst_dispose.
+ */
+void ngram_dispose(ngram_counter_t *counter)
+{
+  while (counter->arena != NULL) {
+    ngram_block_t *next = counter->arena->next;
+    free(counter->arena);
+    counter->arena = next;
+  }
+  free(counter->entries);
+  free(counter->word);
+  free(counter->sorted);
+  counter->entries = NULL;
+  counter->word = NULL;
+  counter->sorted = NULL;
+  counter->size = 0;
+  counter->sorted_size = 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * Hlavičkový soubor pro počítání slov a n-gramů slov.
+ *
+ * Slovo je nejdelší úsek písmen, číslic a bajtů nad 127 (UTF-8), velká
+ * písmena ASCII se převádí na malá. N-gram je n po sobě jdoucích slov
+ * oddělených mezerou, pro n = 1 se tedy počítají slova. Počty se sčítají
+ * v hašovací tabulce a texty n-gramů se ukládají jen jednou do areny, takže
+ * se pro jednotlivé výskyty nic nealokuje.
+ *
+ * Výsledkem je binární vyhledávací strom stejného tvaru jako u letter_count:
+ * klíčem je pořadí n-gramu v abecedně seřazeném seznamu (ngram_token vrátí
+ * jeho text) a hodnotou typu INTEGER počet výskytů. Pořadí klíčů odpovídá
+ * abecednímu pořadí n-gramů, bst_range s mezemi z ngram_key proto vrací
+ * n-gramy z abecedního intervalu.
+ */
+
+#ifndef IAL_BTREE_NGRAM_H
+#define IAL_BTREE_NGRAM_H
+
+#include "../btree.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Blok areny pro texty n-gramů
+typedef struct ngram_block {
+  struct ngram_block *next;   // předchozí blok
+  size_t used;                // obsazené bajty
+  size_t capacity;            // velikost dat v bajtech
+  char data[];                // data
+} ngram_block_t;
+
+// Položka hašovací tabulky
+typedef struct ngram_entry {
+  const char *token;   // text n-gramu v areně (ukončený nulou), NULL = volno
+  uint32_t length;     // délka textu
+  uint32_t hash;       // hash textu (dolní bity určují pozici v tabulce)
+  uint64_t count;      // počet výskytů
+} ngram_entry_t;
+
+// Počítadlo n-gramů
+typedef struct ngram_counter {
+  int n;                     // počet slov v n-gramu
+  ngram_block_t *arena;      // aktuální blok areny
+  ngram_entry_t *entries;    // hašovací tabulka s otevřeným adresováním
+  size_t capacity;           // velikost tabulky (mocnina dvou)
+  size_t size;               // počet různých n-gramů
+  char *word;                // předchozí slova n-gramu a rozpracované slovo
+  size_t word_length;        // délka textu ve word
+  size_t word_capacity;      // velikost bufferu word
+  size_t prefix;             // délka předchozích slov ve word (včetně mezer)
+  int window;                // počet předchozích slov ve word
+  const char **sorted;       // texty seřazené při posledním ngram_build_tree
+  size_t sorted_size;        // počet textů v sorted
+} ngram_counter_t;
+
+void ngram_init(ngram_counter_t *counter, int n);
+void ngram_feed(ngram_counter_t *counter, const char *text, size_t length);
+uint64_t ngram_count(const ngram_counter_t *counter, const char *token);
+void ngram_build_tree(ngram_counter_t *counter, bst_node_t **tree);
+const char *ngram_token(const ngram_counter_t *counter, int key);
+int ngram_key(const ngram_counter_t *counter, const char *token);
+void ngram_dispose(ngram_counter_t *counter);
+
+#endif
@@ -33,7 +33,7 @@ void bst_init(bst_node_t **tree)
  *
  * Funkci implementujte iterativně bez použité vlastních pomocných funkcí.
  */
-bool bst_search(bst_node_t *tree, char key, bst_node_content_t **value)
+bool bst_search(bst_node_t *tree, int key, bst_node_content_t **value)
 {
   bst_node_t *active_node = tree;
   while(active_node != NULL){ // traversing the tree
@@ -63,7 +63,7 @@ bool bst_search(bst_node_t *tree, char key, bst_node_content_t **value)
  *
  * Funkci implementujte iterativně bez použití vlastních pomocných funkcí.
  */
-void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
+void bst_insert(bst_node_t **tree, int key, bst_node_content_t value)
 {
   bst_node_t *active = *tree;
   bst_node_t *parent = NULL;
@@ -71,6 +71,13 @@ void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
   while(active != NULL){ // traversing the tree
     parent = active;
     if(key == active->key){
+#ifdef BST_ORDER_STATISTICS
+      // nothing is inserted, undo the size increments made on the way down
+      for (bst_node_t *node = *tree; node != active;
+           node = key < node->key ? node->left : node->right) {
+        node->size--;
+      }
+#endif
       if (active->content.value != NULL){
         free(active->content.value);
       }
@@ -84,6 +91,9 @@ void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
     else{
       active = active->right;
     }
+#ifdef BST_ORDER_STATISTICS
+    parent->size++; // the new node will end up in this subtree
+#endif
   }
 
   // if key doesnt exist then we insert new node
@@ -96,6 +106,7 @@ void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
   new_node->content = value;
   new_node->left = NULL;
   new_node->right = NULL;
+  BST_UPDATE_SIZE(new_node);
 
   if (parent == NULL){ // if tree was empty then the new node becomes the root
     *tree = new_node;
@@ -133,6 +144,9 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
 
   // we find the rightmost node
   while (active_node->right != NULL) {
+#ifdef BST_ORDER_STATISTICS
+    active_node->size--; // the rightmost node below is going away
+#endif
     parent = active_node;
     active_node = active_node->right;
   }
@@ -173,7 +187,7 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
  * Funkci implementujte iterativně pomocí bst_replace_by_rightmost a bez
  * použití vlastních pomocných funkcí.
  */
-void bst_delete(bst_node_t **tree, char key) {
+void bst_delete(bst_node_t **tree, int key) {
   bst_node_t **active_node_ptr = tree; // to keep track of the parent
   bst_node_t *active_node = *tree;
 
@@ -192,6 +206,14 @@ void bst_delete(bst_node_t **tree, char key) {
     return; // no key found
   }
 
+#ifdef BST_ORDER_STATISTICS
+  // every ancestor loses one node
+  for (bst_node_t *node = *tree; node != active_node;
+       node = key < node->key ? node->left : node->right) {
+    node->size--;
+  }
+#endif
+
   // // if the node has only one subtree
   if (active_node->left == NULL || active_node->right == NULL) {
     bst_node_t *child_node = NULL;
@@ -214,6 +236,7 @@ void bst_delete(bst_node_t **tree, char key) {
   else {
     // replace the node with the rightmost node of the left subtree to keep the tree balanced
     bst_replace_by_rightmost(active_node, &(active_node->left));
+    BST_UPDATE_SIZE(active_node);
   }
 }
 
@@ -261,11 +284,97 @@ void bst_dispose(bst_node_t **tree)
     free(new_node);
     new_node = NULL; // just trying to find the mem leaks
   }
+  stack_bst_dispose(&stack);
 
   // set tree to NULL
   *tree = NULL;
 }
 
+/*
+ * Nalezení uzlu s nejmenším klíčem větším nebo rovným key.
+ *
+ * Pokud takový uzel neexistuje, funkce vrací NULL.
+ *
+ * Funkce je implementovaná iterativně.
+ */
+bst_node_t *bst_lower_bound(bst_node_t *tree, int key)
+{
+  bst_node_t *bound = NULL;
+  bst_node_t *active_node = tree;
+  while (active_node != NULL) {
+    if (active_node->key < key) {
+      active_node = active_node->right; // too small, go right
+    }
+    else {
+      bound = active_node; // candidate, look for a smaller one on the left
+      active_node = active_node->left;
+    }
+  }
+  return bound;
+}
+
+/*
+ * Nalezení uzlu s nejmenším klíčem ostře větším než key.
+ *
+ * Pokud takový uzel neexistuje, funkce vrací NULL.
+ *
+ * Funkce je implementovaná iterativně.
+ */
+bst_node_t *bst_upper_bound(bst_node_t *tree, int key)
+{
+  bst_node_t *bound = NULL;
+  bst_node_t *active_node = tree;
+  while (active_node != NULL) {
+    if (active_node->key <= key) {
+      active_node = active_node->right; // not greater, go right
+    }
+    else {
+      bound = active_node; // candidate, look for a smaller one on the left
+      active_node = active_node->left;
+    }
+  }
+  return bound;
+}
+
+/*
+ * Průchod uzly s klíči z intervalu [low, high) ve vzestupném pořadí.
+ *
+ * Pro každý uzel v intervalu zavolá funkci visit. Podstromy, které leží celé
+ * mimo interval, se neprochází, složitost je O(h + k) pro k nalezených uzlů.
+ *
+ * Funkce je implementovaná iterativně s pomocí zásobníku.
+ */
+void bst_range(bst_node_t *tree, int low, int high, bst_visit_t visit, void *ctx)
+{
+  stack_bst_t stack;
+  stack_bst_init(&stack);
+
+  bst_node_t *active_node = tree;
+  while (true) {
+    // go left, skipping the nodes below low
+    while (active_node != NULL) {
+      if (active_node->key < low) {
+        active_node = active_node->right;
+      }
+      else {
+        stack_bst_push(&stack, active_node);
+        active_node = active_node->left;
+      }
+    }
+
+    if (stack_bst_empty(&stack)) {
+      break;
+    }
+    active_node = stack_bst_pop(&stack);
+    if (active_node->key >= high) { // everything left on the stack is greater
+      break;
+    }
+    visit(active_node, ctx);
+    active_node = active_node->right;
+  }
+  stack_bst_dispose(&stack);
+}
+
 /*
  * Pomocná funkce pro iterativní preorder.
  *
@@ -301,6 +410,7 @@ void bst_leftmost_preorder(bst_node_t *tree, stack_bst_t *to_visit, bst_items_t
  */
 void bst_preorder(bst_node_t *tree, bst_items_t *items)
 {
+  BST_ITEMS_RESERVE_TREE(items, tree);
   // init stack
   stack_bst_t stack;
   stack_bst_init(&stack);
@@ -313,6 +423,7 @@ void bst_preorder(bst_node_t *tree, bst_items_t *items)
     bst_node_t *active_node = stack_bst_pop(&stack); // pop the node
     bst_leftmost_preorder(active_node, &stack, items);
   }
+  stack_bst_dispose(&stack);
 }
 
 /*
@@ -344,6 +455,7 @@ void bst_leftmost_inorder(bst_node_t *tree, stack_bst_t *to_visit)
  */
 void bst_inorder(bst_node_t *tree, bst_items_t *items)
 {
+  BST_ITEMS_RESERVE_TREE(items, tree);
   // init stack
   stack_bst_t stack;
   stack_bst_init(&stack);
@@ -361,6 +473,7 @@ void bst_inorder(bst_node_t *tree, bst_items_t *items)
       bst_leftmost_inorder(active_node->right, &stack);
     }
   }
+  stack_bst_dispose(&stack);
 }
 
 /*
@@ -395,6 +508,7 @@ void bst_leftmost_postorder(bst_node_t *tree, stack_bst_t *to_visit,
  */
 void bst_postorder(bst_node_t *tree, bst_items_t *items)
 {
+  BST_ITEMS_RESERVE_TREE(items, tree);
   // init stack
   stack_bst_t to_visit_stack;
   stack_bst_init(&to_visit_stack);
@@ -422,4 +536,6 @@ void bst_postorder(bst_node_t *tree, bst_items_t *items)
       stack_bst_pop(&to_visit_stack);
     }
   }
+  stack_bst_dispose(&to_visit_stack);
+  stack_bool_dispose(&first_visit);
 }
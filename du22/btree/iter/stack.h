@@ -7,8 +7,8 @@
 
 #include "../btree.h"
 
-// Maximální velikost zásobníku
-#define MAXSTACK 30
+// Počet položek uložených přímo ve struktuře zásobníku (bez alokace)
+#define STACK_INLINE_SIZE 32
 
 /*
  * Makro generující deklarace pro zásobník typu T s názvovým infixem TNAME.
@@ -19,19 +19,27 @@
  *           bst_node_t *stack_bst_pop(stack_bst_t *stack)
  *           bst_node_t *stack_bst_top(stack_bst_t *stack)
  *           bool stack_bst_empty(stack_bst_t *stack)
+ *           void stack_bst_dispose(stack_bst_t *stack)
  * A ekvivalent pro TNAME="bool", T="bool".
+ *
+ * Prvních STACK_INLINE_SIZE položek se ukládá do pole uvnitř struktury,
+ * při zaplnění se zásobník přesune na haldu a jeho kapacita se zdvojnásobuje.
+ * Po použití je nutné zavolat stack_TNAME_dispose.
  */
 #define STACKDEC(T, TNAME)                                                     \
   typedef struct {                                                             \
-    T items[MAXSTACK];                                                         \
+    T inline_items[STACK_INLINE_SIZE];                                         \
+    T *items;                                                                  \
     int top;                                                                   \
+    int capacity;                                                              \
   } stack_##TNAME##_t;                                                         \
                                                                                \
   void stack_##TNAME##_init(stack_##TNAME##_t *stack);                         \
   void stack_##TNAME##_push(stack_##TNAME##_t *stack, T item);                 \
   T stack_##TNAME##_pop(stack_##TNAME##_t *stack);                             \
   T stack_##TNAME##_top(stack_##TNAME##_t *stack);                             \
-  bool stack_##TNAME##_empty(stack_##TNAME##_t *stack);
+  bool stack_##TNAME##_empty(stack_##TNAME##_t *stack);                        \
+  void stack_##TNAME##_dispose(stack_##TNAME##_t *stack);
 
 STACKDEC(bst_node_t *, bst)
 STACKDEC(bool, bool)
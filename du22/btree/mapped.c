@@ -0,0 +1,387 @@
+/*
+ * Binární vyhledávací strom mapovaný ze souboru
+ *
+ * Export zapisuje uzly přímo do namapovaného souboru: první průchod spočítá
+ * uzly a velikost jmen, druhý průchod v pořadí preorder vyplní pole uzlů
+ * a do rodiče doplní index potomka, jakmile ho potomek dostane. Otevření
+ * soubor namapuje jen pro čtení a jednou ho zkontroluje (indexy, uspořádání
+ * klíčů, řetězce), ostatní funkce už kontroly neopakují.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "mapped.h"
+#include "character.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char bst_mapped_magic[4] = {'B', 'S', 'T', 'M'};
+
+// Hlavička souboru, za ní následuje pole uzlů a oblast řetězců
+typedef struct bst_mapped_header {
+  char magic[4];          // "BSTM"
+  uint32_t count;         // počet uzlů
+  uint32_t strings_size;  // velikost oblasti řetězců v bajtech
+} bst_mapped_header_t;
+
+/*
+ * Pomocná funkce pro zvětšení pole zásobníku na dvojnásobek.
+ */
+static void *bst_mapped_grow(void *items, int *capacity, size_t item_size)
+{
+  *capacity *= 2;
+  void *grown = realloc(items, *capacity * item_size);
+  if (grown == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  return grown;
+}
+
+// Uzel čekající na zápis a pole rodiče, kam patří jeho index
+typedef struct bst_export_slot {
+  bst_node_t *node;
+  uint32_t *link;
+} bst_export_slot_t;
+
+/*
+ * Export stromu do souboru path pro pozdější bst_open_mmap.
+ *
+ * Existující soubor se přepíše. Funkce vrací false, pokud soubor nejde
+ * vytvořit nebo namapovat, nebo pokud je strom na 32bitové indexy moc
+ * velký.
+ */
+bool bst_export_mmap(bst_node_t *tree, const char *path)
+{
+  uint64_t count = 0, strings_size = 0;
+  bst_cursor_t cursor;
+  bst_cursor_init(&cursor, tree, BST_PREORDER);
+  bst_node_t *node;
+  while ((node = bst_cursor_next(&cursor)) != NULL) {
+    count++;
+    if (node->content.type == CHARACTER_T && node->content.value != NULL) {
+      character_t *character = node->content.value;
+      if (character->name != NULL) {
+        strings_size += strlen(character->name) + 1;
+      }
+    }
+  }
+  bst_cursor_dispose(&cursor);
+  if (count >= BST_MAPPED_NONE || strings_size > UINT32_MAX) {
+    return false;
+  }
+
+  size_t length = sizeof(bst_mapped_header_t) +
+                  count * sizeof(bst_mapped_node_t) + strings_size;
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, length) != 0) {
+    close(fd);
+    return false;
+  }
+  void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+
+  bst_mapped_header_t *header = base;
+  memcpy(header->magic, bst_mapped_magic, sizeof(bst_mapped_magic));
+  header->count = count;
+  header->strings_size = strings_size;
+  bst_mapped_node_t *nodes = (bst_mapped_node_t *)(header + 1);
+  char *strings = (char *)(nodes + count);
+
+  int size = 0, capacity = 64;
+  bst_export_slot_t *stack = malloc(capacity * sizeof(bst_export_slot_t));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  if (tree != NULL) {
+    stack[size++] = (bst_export_slot_t){.node = tree, .link = NULL};
+  }
+
+  uint32_t index = 0, offset = 0;
+  while (size > 0) {
+    bst_export_slot_t slot = stack[--size];
+    node = slot.node;
+    if (slot.link != NULL) {
+      *slot.link = index;
+    }
+    bst_mapped_node_t *mapped = &nodes[index++];
+    *mapped = (bst_mapped_node_t){
+        .key = node->key,
+        .left = BST_MAPPED_NONE,
+        .right = BST_MAPPED_NONE,
+        .type = node->content.type,
+    };
+    if (node->content.value == NULL) {
+      mapped->flags = BST_MAPPED_NULL_VALUE;
+    }
+    else if (node->content.type == INTEGER) {
+      mapped->value = (uint32_t)*(int *)node->content.value;
+    }
+    else if (node->content.type == CHARACTER_T) {
+      character_t *character = node->content.value;
+      mapped->character_class = character->character_class;
+      mapped->level = character->level;
+      if (character->name == NULL) {
+        mapped->flags = BST_MAPPED_NULL_NAME;
+      }
+      else {
+        size_t name_size = strlen(character->name) + 1;
+        memcpy(strings + offset, character->name, name_size);
+        mapped->value = offset;
+        offset += name_size;
+      }
+    }
+
+    // the left subtree follows first in preorder, so it goes on top
+    if (size + 2 > capacity) {
+      stack = bst_mapped_grow(stack, &capacity, sizeof(bst_export_slot_t));
+    }
+    if (node->right != NULL) {
+      stack[size++] =
+          (bst_export_slot_t){.node = node->right, .link = &mapped->right};
+    }
+    if (node->left != NULL) {
+      stack[size++] =
+          (bst_export_slot_t){.node = node->left, .link = &mapped->left};
+    }
+  }
+  free(stack);
+  return munmap(base, length) == 0;
+}
+
+// Uzel ke kontrole s povoleným intervalem klíčů
+typedef struct bst_check_slot {
+  uint32_t index;
+  int64_t low;   // exclusive
+  int64_t high;  // exclusive
+} bst_check_slot_t;
+
+/*
+ * Kontrola namapovaného stromu. Průchod preorder musí navštívit uzly
+ * přesně v pořadí jejich indexů, takže každý uzel má jediného rodiče
+ * a stromem nejde projít do cyklu.
+ */
+static bool bst_mapped_check(const bst_mapped_t *mapped)
+{
+  if (mapped->strings_size > 0 &&
+      mapped->strings[mapped->strings_size - 1] != '\0') {
+    return false;
+  }
+
+  int size = 0, capacity = 64;
+  bst_check_slot_t *stack = malloc(capacity * sizeof(bst_check_slot_t));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  if (mapped->count > 0) {
+    stack[size++] =
+        (bst_check_slot_t){.index = 0, .low = INT64_MIN, .high = INT64_MAX};
+  }
+
+  bool ok = true;
+  uint32_t visited = 0;
+  while (ok && size > 0) {
+    bst_check_slot_t slot = stack[--size];
+    const bst_mapped_node_t *node = &mapped->nodes[slot.index];
+    if (slot.index != visited++ || node->key <= slot.low ||
+        node->key >= slot.high || node->type > CHARACTER_T ||
+        (node->type == CHARACTER_T && node->flags == 0 &&
+         node->value >= mapped->strings_size)) {
+      ok = false;
+      break;
+    }
+    if (size + 2 > capacity) {
+      stack = bst_mapped_grow(stack, &capacity, sizeof(bst_check_slot_t));
+    }
+    if (node->right != BST_MAPPED_NONE) {
+      stack[size++] = (bst_check_slot_t){
+          .index = node->right, .low = node->key, .high = slot.high};
+    }
+    if (node->left != BST_MAPPED_NONE) {
+      stack[size++] = (bst_check_slot_t){
+          .index = node->left, .low = slot.low, .high = node->key};
+    }
+    // an index past the array can never match visited, but it must not be read
+    ok = (node->right == BST_MAPPED_NONE || node->right < mapped->count) &&
+         (node->left == BST_MAPPED_NONE || node->left < mapped->count);
+  }
+  free(stack);
+  return ok && visited == mapped->count;
+}
+
+/*
+ * Otevření stromu exportovaného funkcí bst_export_mmap.
+ *
+ * Soubor se namapuje jen pro čtení a zkontroluje. Funkce vrací false, pokud
+ * soubor nejde otevřít nebo jeho obsah není platný strom. Strom je nutné
+ * zavřít funkcí bst_close_mmap.
+ */
+bool bst_open_mmap(bst_mapped_t *mapped, const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(bst_mapped_header_t)) {
+    close(fd);
+    return false;
+  }
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+
+  const bst_mapped_header_t *header = base;
+  mapped->base = base;
+  mapped->length = st.st_size;
+  mapped->nodes = (const bst_mapped_node_t *)(header + 1);
+  mapped->count = header->count;
+  mapped->strings = (const char *)(mapped->nodes + header->count);
+  mapped->strings_size = header->strings_size;
+
+  uint64_t expected = sizeof(bst_mapped_header_t) +
+                      (uint64_t)header->count * sizeof(bst_mapped_node_t) +
+                      header->strings_size;
+  if (memcmp(header->magic, bst_mapped_magic, sizeof(bst_mapped_magic)) != 0 ||
+      expected != mapped->length || !bst_mapped_check(mapped)) {
+    bst_close_mmap(mapped);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Zavření namapovaného stromu.
+ */
+void bst_close_mmap(bst_mapped_t *mapped)
+{
+  if (mapped->base != NULL) {
+    munmap(mapped->base, mapped->length);
+  }
+  mapped->base = NULL;
+  mapped->length = 0;
+  mapped->nodes = NULL;
+  mapped->count = 0;
+  mapped->strings = NULL;
+  mapped->strings_size = 0;
+}
+
+/*
+ * Vyhledání uzlu s klíčem key. Funkce vrací uzel v namapovaném souboru,
+ * nebo NULL, pokud ve stromu není.
+ */
+const bst_mapped_node_t *bst_mapped_search(const bst_mapped_t *mapped, int key)
+{
+  uint32_t index = mapped->count > 0 ? 0 : BST_MAPPED_NONE;
+  while (index != BST_MAPPED_NONE) {
+    const bst_mapped_node_t *node = &mapped->nodes[index];
+    if (key == node->key) {
+      return node;
+    }
+    index = key < node->key ? node->left : node->right;
+  }
+  return NULL;
+}
+
+/*
+ * Průchod uzly s klíči z intervalu [low, high) ve vzestupném pořadí.
+ *
+ * Stejně jako bst_range vynechá podstromy, které leží celé mimo interval.
+ */
+void bst_mapped_range(const bst_mapped_t *mapped, int low, int high,
+                      bst_mapped_visit_t visit, void *ctx)
+{
+  int size = 0, capacity = 64;
+  uint32_t *stack = malloc(capacity * sizeof(uint32_t));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+
+  uint32_t index = mapped->count > 0 ? 0 : BST_MAPPED_NONE;
+  while (true) {
+    // go left, skipping the nodes below low
+    while (index != BST_MAPPED_NONE) {
+      const bst_mapped_node_t *node = &mapped->nodes[index];
+      if (node->key < low) {
+        index = node->right;
+      }
+      else {
+        if (size == capacity) {
+          stack = bst_mapped_grow(stack, &capacity, sizeof(uint32_t));
+        }
+        stack[size++] = index;
+        index = node->left;
+      }
+    }
+
+    if (size == 0) {
+      break;
+    }
+    const bst_mapped_node_t *node = &mapped->nodes[stack[--size]];
+    if (node->key >= high) { // everything left on the stack is greater
+      break;
+    }
+    visit(mapped, node, ctx);
+    index = node->right;
+  }
+  free(stack);
+}
+
+/*
+ * Inorder průchod celým namapovaným stromem.
+ */
+void bst_mapped_inorder(const bst_mapped_t *mapped, bst_mapped_visit_t visit,
+                        void *ctx)
+{
+  bst_mapped_range(mapped, INT32_MIN, INT32_MAX, visit, ctx);
+  const bst_mapped_node_t *last = bst_mapped_search(mapped, INT32_MAX);
+  if (last != NULL) { // the range above is half-open
+    visit(mapped, last, ctx);
+  }
+}
+
+/*
+ * Jméno postavy uložené v uzlu, nebo NULL, pokud uzel postavu se jménem
+ * neobsahuje.
+ */
+const char *bst_mapped_name(const bst_mapped_t *mapped,
+                            const bst_mapped_node_t *node)
+{
+  if (node->type != CHARACTER_T || node->flags != 0) {
+    return NULL;
+  }
+  return mapped->strings + node->value;
+}
+
+/*
+ * Pomocná funkce pro výpis uzlu namapovaného stromu ve stejném tvaru jako
+ * bst_print_node.
+ */
+void bst_mapped_print_node(const bst_mapped_t *mapped,
+                           const bst_mapped_node_t *node)
+{
+  printf("[%c,", node->key);
+  if (node->flags & BST_MAPPED_NULL_VALUE) {
+    printf("NULL");
+  }
+  else if (node->type == INTEGER) {
+    printf("%d", (int32_t)node->value);
+  }
+  else {
+    const char *name = bst_mapped_name(mapped, node);
+    printf("%s, %s, %u", name != NULL ? name : "NULL",
+           character_class_to_string(node->character_class), node->level);
+  }
+  printf("]");
+}
@@ -0,0 +1,68 @@
+/*
+ * Hlavičkový soubor pro binární vyhledávací strom mapovaný ze souboru.
+ *
+ * Strom se exportuje jako hlavička, pole uzlů pevné velikosti v pořadí
+ * preorder a oblast řetězců se jmény postav. Potomci se odkazují 32bitovými
+ * indexy do pole uzlů místo ukazatelů, takže soubor nezávisí na adrese, na
+ * kterou se namapuje, a uzel zabere 20 bajtů místo 40. Čísla se ukládají
+ * v pořadí bajtů stroje, který soubor vytvořil.
+ *
+ * Otevřený strom je jen pro čtení: vyhledávání a průchody pracují přímo nad
+ * namapovanými stránkami, které procesy čtoucí stejný soubor sdílí.
+ */
+
+#ifndef IAL_BTREE_MAPPED_H
+#define IAL_BTREE_MAPPED_H
+
+#include "btree.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Index chybějícího potomka
+#define BST_MAPPED_NONE UINT32_MAX
+
+// příznaky uzlu
+#define BST_MAPPED_NULL_VALUE 0x01
+#define BST_MAPPED_NULL_NAME 0x02
+
+// Uzel stromu v souboru
+typedef struct bst_mapped_node {
+  int32_t key;              // klíč
+  uint32_t left;            // index levého potomka nebo BST_MAPPED_NONE
+  uint32_t right;           // index pravého potomka nebo BST_MAPPED_NONE
+  uint32_t value;           // INTEGER: hodnota, CHARACTER_T: offset jména
+  uint8_t type;             // datový typ hodnoty
+  uint8_t flags;            // příznaky BST_MAPPED_*
+  uint8_t character_class;  // CHARACTER_T: povolání
+  uint8_t level;            // CHARACTER_T: úroveň
+} bst_mapped_node_t;
+
+// Strom otevřený ze souboru
+typedef struct bst_mapped {
+  void *base;                       // začátek mapování
+  size_t length;                    // délka mapování v bajtech
+  const bst_mapped_node_t *nodes;   // pole uzlů
+  uint32_t count;                   // počet uzlů
+  const char *strings;              // oblast řetězců
+  uint32_t strings_size;            // velikost oblasti řetězců v bajtech
+} bst_mapped_t;
+
+// Funkce volaná pro každý navštívený uzel mapovaného stromu
+typedef void (*bst_mapped_visit_t)(const bst_mapped_t *mapped,
+                                   const bst_mapped_node_t *node, void *ctx);
+
+bool bst_export_mmap(bst_node_t *tree, const char *path);
+bool bst_open_mmap(bst_mapped_t *mapped, const char *path);
+void bst_close_mmap(bst_mapped_t *mapped);
+
+const bst_mapped_node_t *bst_mapped_search(const bst_mapped_t *mapped, int key);
+void bst_mapped_range(const bst_mapped_t *mapped, int low, int high,
+                      bst_mapped_visit_t visit, void *ctx);
+void bst_mapped_inorder(const bst_mapped_t *mapped, bst_mapped_visit_t visit,
+                        void *ctx);
+const char *bst_mapped_name(const bst_mapped_t *mapped,
+                            const bst_mapped_node_t *node);
+void bst_mapped_print_node(const bst_mapped_t *mapped,
+                           const bst_mapped_node_t *node);
+
+#endif
@@ -0,0 +1,453 @@
+/*
+ * Paralelní průchody binárním vyhledávacím stromem.
+ *
+ * Každé vlákno má vlastní frontu podstromů ke zpracování. Vlákno bere úlohy
+ * z konce své fronty a když je prázdná, krade nejstarší úlohy ostatním.
+ * Pravé podstromy se do fronty zveřejňují jen tehdy, když je fronta vlákna
+ * prázdná, jinak se zpracují lokálně bez synchronizace.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "parallel.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Počet částí inorder průchodu připadajících na jedno vlákno
+#define BST_PARALLEL_PIECES 8
+
+// Velikost lokálního zásobníku pravých podstromů jednoho vlákna
+#define BST_PARALLEL_LOCAL 64
+
+// Rozestup dílčích výsledků vláken v poli (jedna cache line)
+#define BST_PARALLEL_STRIDE 8
+
+// Fronta úloh jednoho vlákna
+typedef struct bst_deque {
+  void **tasks;          // úlohy
+  int head;              // nejstarší úloha (kradou ostatní vlákna)
+  int tail;              // za nejnovější úlohou (bere vlastník)
+  int capacity;          // kapacita pole úloh
+  atomic_int size;       // počet úloh, čte se bez zámku
+  pthread_mutex_t lock;  // zámek fronty
+} bst_deque_t;
+
+typedef struct bst_pool bst_pool_t;
+
+// Zpracování jedné úlohy vláknem worker
+typedef void (*bst_task_t)(bst_pool_t *pool, int worker, void *task);
+
+// Zpracování jednoho uzlu při průchodu podstromem
+typedef void (*bst_node_op_t)(bst_pool_t *pool, int worker, bst_node_t *node);
+
+// Skupina vláken s frontami úloh
+struct bst_pool {
+  int workers;              // počet vláken
+  bst_deque_t *deques;      // fronty jednotlivých vláken
+  atomic_long pending;      // zveřejněné a dosud nedokončené úlohy
+  bst_task_t run;           // zpracování úlohy
+  bst_node_op_t node_op;    // zpracování uzlu (průchod podstromem)
+  bst_visit_t visit;        // bst_parallel_for_each
+  void *ctx;                // kontext pro visit a map
+  bst_map_t map;            // bst_parallel_reduce
+  bst_combine_t combine;    // bst_parallel_reduce
+  long *partial;            // dílčí výsledky vláken
+};
+
+// Argument vlákna
+typedef struct bst_worker {
+  bst_pool_t *pool;
+  int index;
+} bst_worker_t;
+
+// Část inorder průchodu: samostatný uzel, nebo celý podstrom
+typedef struct bst_piece {
+  bst_node_t *node;     // uzel nebo kořen podstromu
+  bool subtree;         // true, pokud se má projít celý podstrom
+  bst_items_t items;    // uzly podstromu v pořadí inorder
+} bst_piece_t;
+
+static void bst_deque_push(bst_deque_t *deque, void *task)
+{
+  pthread_mutex_lock(&deque->lock);
+  if (deque->tail == deque->capacity) {
+    if (deque->head > 0) { // reuse the space freed by thieves
+      memmove(deque->tasks, &deque->tasks[deque->head],
+              (deque->tail - deque->head) * sizeof(void *));
+      deque->tail -= deque->head;
+      deque->head = 0;
+    }
+    if (deque->tail == deque->capacity) {
+      deque->capacity = deque->capacity * 2 + 16;
+      deque->tasks = realloc(deque->tasks, deque->capacity * sizeof(void *));
+      if (deque->tasks == NULL) {
+        exit(EXIT_FAILURE); // error handling
+      }
+    }
+  }
+  deque->tasks[deque->tail++] = task;
+  atomic_fetch_add(&deque->size, 1);
+  pthread_mutex_unlock(&deque->lock);
+}
+
+/*
+ * Odebere nejnovější úlohu (vlastník fronty), nebo nejstarší úlohu (zloděj).
+ */
+static void *bst_deque_take(bst_deque_t *deque, bool steal)
+{
+  if (atomic_load(&deque->size) == 0) {
+    return NULL;
+  }
+  void *task = NULL;
+  pthread_mutex_lock(&deque->lock);
+  if (deque->head < deque->tail) {
+    task = steal ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+    atomic_fetch_sub(&deque->size, 1);
+    if (deque->head == deque->tail) {
+      deque->head = deque->tail = 0;
+    }
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return task;
+}
+
+static void bst_pool_init(bst_pool_t *pool, int threads)
+{
+  memset(pool, 0, sizeof(*pool));
+  pool->workers = threads > 0 ? threads : 1;
+  pool->deques = calloc(pool->workers, sizeof(bst_deque_t));
+  if (pool->deques == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  for (int i = 0; i < pool->workers; i++) {
+    atomic_init(&pool->deques[i].size, 0);
+    pthread_mutex_init(&pool->deques[i].lock, NULL);
+  }
+  atomic_init(&pool->pending, 0);
+}
+
+static void bst_pool_destroy(bst_pool_t *pool)
+{
+  for (int i = 0; i < pool->workers; i++) {
+    free(pool->deques[i].tasks);
+    pthread_mutex_destroy(&pool->deques[i].lock);
+  }
+  free(pool->deques);
+}
+
+/*
+ * Zveřejnění úlohy ve frontě vlákna worker.
+ */
+static void bst_pool_push(bst_pool_t *pool, int worker, void *task)
+{
+  atomic_fetch_add(&pool->pending, 1);
+  bst_deque_push(&pool->deques[worker], task);
+}
+
+static void bst_worker_loop(bst_pool_t *pool, int worker)
+{
+  while (true) {
+    void *task = bst_deque_take(&pool->deques[worker], false);
+    for (int i = 1; task == NULL && i < pool->workers; i++) { // try to steal
+      task = bst_deque_take(&pool->deques[(worker + i) % pool->workers], true);
+    }
+
+    if (task != NULL) {
+      pool->run(pool, worker, task);
+      atomic_fetch_sub(&pool->pending, 1);
+    }
+    else if (atomic_load(&pool->pending) == 0) {
+      return; // nothing queued and nothing running that could queue more
+    }
+    else {
+      sched_yield();
+    }
+  }
+}
+
+static void *bst_worker_main(void *arg)
+{
+  bst_worker_t *worker = arg;
+  bst_worker_loop(worker->pool, worker->index);
+  return NULL;
+}
+
+/*
+ * Spuštění vláken nad zveřejněnými úlohami, volající vlákno je vláknem 0.
+ * Funkce skončí, až jsou všechny úlohy zpracované.
+ */
+static void bst_pool_run(bst_pool_t *pool)
+{
+  int extra = pool->workers - 1;
+  pthread_t *threads = malloc((extra + 1) * sizeof(pthread_t));
+  bst_worker_t *args = malloc((extra + 1) * sizeof(bst_worker_t));
+  bool *started = calloc(extra + 1, sizeof(bool));
+  if (threads == NULL || args == NULL || started == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+
+  for (int i = 0; i < extra; i++) {
+    args[i].pool = pool;
+    args[i].index = i + 1;
+    // a thread that fails to start only means less parallelism, its queue is stolen from
+    started[i] = pthread_create(&threads[i], NULL, bst_worker_main, &args[i]) == 0;
+  }
+  bst_worker_loop(pool, 0);
+  for (int i = 0; i < extra; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  free(threads);
+  free(args);
+  free(started);
+}
+
+/*
+ * Úloha, která projde podstrom a na každý uzel zavolá pool->node_op.
+ *
+ * Potomci se přečtou dřív, než se uzel zpracuje, takže node_op smí uzel
+ * uvolnit.
+ */
+static void bst_walk_subtree(bst_pool_t *pool, int worker, void *task)
+{
+  bst_node_t *local[BST_PARALLEL_LOCAL];
+  int local_size = 0;
+  bst_node_t *node = task;
+
+  while (true) {
+    while (node != NULL) {
+      bst_node_t *left = node->left;
+      bst_node_t *right = node->right;
+      if (right != NULL) {
+        // share the work while nobody has anything to steal from us
+        if (local_size == BST_PARALLEL_LOCAL ||
+            atomic_load(&pool->deques[worker].size) == 0) {
+          bst_pool_push(pool, worker, right);
+        }
+        else {
+          local[local_size++] = right;
+        }
+      }
+      pool->node_op(pool, worker, node);
+      node = left;
+    }
+    if (local_size == 0) {
+      break;
+    }
+    node = local[--local_size];
+  }
+}
+
+/*
+ * Společná část paralelních průchodů podstromy.
+ */
+static void bst_pool_walk(bst_pool_t *pool, bst_node_t *tree)
+{
+  if (tree == NULL) {
+    return;
+  }
+  pool->run = bst_walk_subtree;
+  bst_pool_push(pool, 0, tree);
+  bst_pool_run(pool);
+}
+
+static void bst_dispose_node(bst_pool_t *pool, int worker, bst_node_t *node)
+{
+  if (node->content.value != NULL) {
+    free(node->content.value);
+  }
+  free(node);
+}
+
+static void bst_visit_node(bst_pool_t *pool, int worker, bst_node_t *node)
+{
+  pool->visit(node, pool->ctx);
+}
+
+static void bst_reduce_node(bst_pool_t *pool, int worker, bst_node_t *node)
+{
+  long *partial = &pool->partial[worker * BST_PARALLEL_STRIDE];
+  *partial = pool->combine(*partial, pool->map(node, pool->ctx));
+}
+
+/*
+ * Paralelní zrušení celého stromu.
+ *
+ * Po zrušení se strom bude nacházet ve stejném stavu jako po inicializaci.
+ */
+void bst_parallel_dispose(bst_node_t **tree, int threads)
+{
+  bst_pool_t pool;
+  bst_pool_init(&pool, threads);
+  pool.node_op = bst_dispose_node;
+  bst_pool_walk(&pool, *tree);
+  bst_pool_destroy(&pool);
+  *tree = NULL;
+}
+
+/*
+ * Paralelní průchod všemi uzly stromu v libovolném pořadí.
+ *
+ * Funkce visit je volána souběžně z více vláken a musí být vláknově
+ * bezpečná. Strom se během průchodu nesmí měnit.
+ */
+void bst_parallel_for_each(bst_node_t *tree, bst_visit_t visit, void *ctx,
+                           int threads)
+{
+  bst_pool_t pool;
+  bst_pool_init(&pool, threads);
+  pool.node_op = bst_visit_node;
+  pool.visit = visit;
+  pool.ctx = ctx;
+  bst_pool_walk(&pool, tree);
+  bst_pool_destroy(&pool);
+}
+
+/*
+ * Paralelní map/reduce nad uzly stromu.
+ *
+ * Funkce map se zavolá souběžně pro každý uzel, výsledky spojí funkce
+ * combine, která musí být asociativní a komutativní. Pro prázdný strom
+ * funkce vrací identity.
+ */
+long bst_parallel_reduce(bst_node_t *tree, bst_map_t map, bst_combine_t combine,
+                         long identity, void *ctx, int threads)
+{
+  bst_pool_t pool;
+  bst_pool_init(&pool, threads);
+  pool.node_op = bst_reduce_node;
+  pool.map = map;
+  pool.combine = combine;
+  pool.ctx = ctx;
+  pool.partial = malloc(pool.workers * BST_PARALLEL_STRIDE * sizeof(long));
+  if (pool.partial == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  for (int i = 0; i < pool.workers; i++) {
+    pool.partial[i * BST_PARALLEL_STRIDE] = identity;
+  }
+
+  bst_pool_walk(&pool, tree);
+
+  long result = identity;
+  for (int i = 0; i < pool.workers; i++) {
+    result = combine(result, pool.partial[i * BST_PARALLEL_STRIDE]);
+  }
+  free(pool.partial);
+  bst_pool_destroy(&pool);
+  return result;
+}
+
+/*
+ * Úloha inorder průchodu, která uloží uzly jednoho podstromu do jeho pole.
+ */
+static void bst_fill_piece(bst_pool_t *pool, int worker, void *task)
+{
+  bst_piece_t *piece = task;
+  bst_cursor_t cursor;
+  bst_cursor_init(&cursor, piece->node, BST_INORDER);
+  bst_node_t *node;
+  while ((node = bst_cursor_next(&cursor)) != NULL) {
+    bst_add_node_to_items(node, &piece->items);
+  }
+  bst_cursor_dispose(&cursor);
+}
+
+/*
+ * Pomocná funkce, která rozloží horní patra stromu na posloupnost samostatných
+ * uzlů a podstromů v pořadí inorder, dokud podstromů není alespoň target.
+ * Rozkládání skončí i tehdy, když další patro počet podstromů nezvýší
+ * (degenerovaný strom), jinak by se řetěz odlupoval po jednom uzlu v O(n^2).
+ */
+static bst_piece_t *bst_split_pieces(bst_node_t *tree, int target, int *count)
+{
+  bst_piece_t *pieces = malloc(sizeof(bst_piece_t));
+  if (pieces == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  pieces[0] = (bst_piece_t){.node = tree, .subtree = true};
+  *count = 1;
+
+  int subtrees = 1;
+  while (subtrees < target) {
+    // every subtree becomes left subtree, node, right subtree
+    bst_piece_t *split = malloc(*count * 3 * sizeof(bst_piece_t));
+    if (split == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    int split_count = 0;
+    int split_subtrees = 0;
+    for (int i = 0; i < *count; i++) {
+      bst_node_t *node = pieces[i].node;
+      if (!pieces[i].subtree) {
+        split[split_count++] = pieces[i];
+        continue;
+      }
+      if (node->left != NULL) {
+        split[split_count++] = (bst_piece_t){.node = node->left, .subtree = true};
+        split_subtrees++;
+      }
+      split[split_count++] = (bst_piece_t){.node = node, .subtree = false};
+      if (node->right != NULL) {
+        split[split_count++] = (bst_piece_t){.node = node->right, .subtree = true};
+        split_subtrees++;
+      }
+    }
+    free(pieces);
+    pieces = split;
+    *count = split_count;
+    if (split_subtrees <= subtrees) {
+      break; // no branching left (a chain), the rest goes to a worker as is
+    }
+    subtrees = split_subtrees;
+  }
+  return pieces;
+}
+
+/*
+ * Paralelní inorder průchod stromem.
+ *
+ * Horní patra stromu se rozloží na podstromy, které vlákna projdou každý do
+ * vlastního pole. Pole se nakonec spojí v pořadí inorder, výsledek je proto
+ * stejný jako u bst_inorder.
+ */
+void bst_parallel_inorder(bst_node_t *tree, bst_items_t *items, int threads)
+{
+  if (tree == NULL) {
+    return;
+  }
+
+  bst_pool_t pool;
+  bst_pool_init(&pool, threads);
+  pool.run = bst_fill_piece;
+
+  int count;
+  bst_piece_t *pieces = bst_split_pieces(tree, pool.workers * BST_PARALLEL_PIECES,
+                                         &count);
+  int next_worker = 0;
+  for (int i = 0; i < count; i++) {
+    bst_items_init(&pieces[i].items);
+    if (pieces[i].subtree) { // spread the subtrees over all queues
+      bst_pool_push(&pool, next_worker, &pieces[i]);
+      next_worker = (next_worker + 1) % pool.workers;
+    }
+  }
+  bst_pool_run(&pool);
+
+  for (int i = 0; i < count; i++) {
+    if (!pieces[i].subtree) {
+      bst_add_node_to_items(pieces[i].node, items);
+      continue;
+    }
+    for (int j = 0; j < pieces[i].items.size; j++) {
+      bst_add_node_to_items(pieces[i].items.nodes[j], items);
+    }
+    free(pieces[i].items.nodes);
+  }
+  free(pieces);
+  bst_pool_destroy(&pool);
+}
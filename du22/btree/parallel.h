@@ -0,0 +1,26 @@
+/*
+ * Hlavičkový soubor pro paralelní průchody binárním vyhledávacím stromem.
+ *
+ * Strom se dělí na podstromy, které si mezi sebou rozebírají vlákna
+ * s vlastními frontami úloh (work stealing).
+ */
+
+#ifndef IAL_BTREE_PARALLEL_H
+#define IAL_BTREE_PARALLEL_H
+
+#include "btree.h"
+
+// Funkce, která pro uzel vrátí hodnotu pro bst_parallel_reduce
+typedef long (*bst_map_t)(bst_node_t *node, void *ctx);
+
+// Asociativní a komutativní funkce, která spojí dvě dílčí hodnoty
+typedef long (*bst_combine_t)(long left, long right);
+
+void bst_parallel_dispose(bst_node_t **tree, int threads);
+void bst_parallel_for_each(bst_node_t *tree, bst_visit_t visit, void *ctx,
+                           int threads);
+void bst_parallel_inorder(bst_node_t *tree, bst_items_t *items, int threads);
+long bst_parallel_reduce(bst_node_t *tree, bst_map_t map, bst_combine_t combine,
+                         long identity, void *ctx, int threads);
+
+#endif
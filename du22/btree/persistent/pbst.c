@@ -0,0 +1,331 @@
+/*
+ * Perzistentní binární vyhledávací strom
+ *
+ * Každá verze stromu je určená svým kořenem. Změna vytvoří kopie uzlů na
+ * cestě od kořene k měněnému místu; kopie odkazují na původní sousední
+ * podstromy, jejichž počítadla odkazů se zvýší. Uvolnění verze sníží
+ * počítadlo kořene a uzly, na které už nic neodkazuje, uvolní dál směrem
+ * k listům. Počítadla jsou atomická, takže různé verze lze číst a uvolňovat
+ * z více vláken současně.
+ *
+ * Funkce pbst_insert a pbst_delete původní verzi nemění ani neuvolňují,
+ * volající vlastní jeden odkaz na vrácenou verzi.
+ */
+
+#include "pbst.h"
+#include <stdlib.h>
+
+/*
+ * Vytvoření sdílené hodnoty.
+ */
+static pbst_value_t *pbst_value_create(bst_node_content_t content)
+{
+  pbst_value_t *value = malloc(sizeof(pbst_value_t));
+  if (value == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  atomic_init(&value->refs, 1);
+  value->content = content;
+  return value;
+}
+
+static void pbst_value_release(pbst_value_t *value)
+{
+  if (atomic_fetch_sub_explicit(&value->refs, 1, memory_order_acq_rel) == 1) {
+    free(value->content.value);
+    free(value);
+  }
+}
+
+/*
+ * Vytvoření uzlu. Uzel přebírá odkazy na hodnotu i na oba potomky.
+ */
+static pbst_node_t *pbst_node_create(int key, pbst_value_t *value,
+                                     pbst_node_t *left, pbst_node_t *right)
+{
+  pbst_node_t *node = malloc(sizeof(pbst_node_t));
+  if (node == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  node->key = key;
+  node->value = value;
+  node->left = left;
+  node->right = right;
+  atomic_init(&node->refs, 1);
+  return node;
+}
+
+/*
+ * Přidání odkazu na verzi stromu (i prázdnou).
+ *
+ * Vrací stejný kořen, takže snímek verze je jediné atomické přičtení.
+ */
+pbst_node_t *pbst_retain(pbst_node_t *tree)
+{
+  if (tree != NULL) {
+    atomic_fetch_add_explicit(&tree->refs, 1, memory_order_relaxed);
+  }
+  return tree;
+}
+
+/*
+ * Uvolnění odkazu na verzi stromu.
+ *
+ * Uzly, na které po uvolnění nic neodkazuje, se ruší iterativně, takže
+ * ani uvolnění zdegenerovaného stromu nespotřebuje zásobník volání.
+ */
+void pbst_release(pbst_node_t *tree)
+{
+  if (tree == NULL ||
+      atomic_fetch_sub_explicit(&tree->refs, 1, memory_order_acq_rel) != 1) {
+    return;
+  }
+  int size = 0, capacity = 64;
+  pbst_node_t **stack = malloc(capacity * sizeof(pbst_node_t *));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  stack[size++] = tree;
+  while (size > 0) {
+    pbst_node_t *node = stack[--size];
+    pbst_node_t *children[2] = {node->left, node->right};
+    pbst_value_release(node->value);
+    free(node);
+    for (int i = 0; i < 2; i++) {
+      pbst_node_t *child = children[i];
+      if (child == NULL || atomic_fetch_sub_explicit(
+                               &child->refs, 1, memory_order_acq_rel) != 1) {
+        continue;
+      }
+      if (size == capacity) {
+        capacity *= 2;
+        pbst_node_t **grown = realloc(stack, capacity * sizeof(pbst_node_t *));
+        if (grown == NULL) {
+          exit(EXIT_FAILURE);
+        }
+        stack = grown;
+      }
+      stack[size++] = child;
+    }
+  }
+  free(stack);
+}
+
+static pbst_value_t *pbst_value_retain(pbst_value_t *value)
+{
+  atomic_fetch_add_explicit(&value->refs, 1, memory_order_relaxed);
+  return value;
+}
+
+// Cesta od kořene ke kopírovanému uzlu
+typedef struct pbst_path {
+  pbst_node_t **nodes;
+  int size;
+  int capacity;
+} pbst_path_t;
+
+static void pbst_path_push(pbst_path_t *path, pbst_node_t *node)
+{
+  if (path->size == path->capacity) {
+    path->capacity = path->capacity == 0 ? 32 : 2 * path->capacity;
+    pbst_node_t **grown =
+        realloc(path->nodes, path->capacity * sizeof(pbst_node_t *));
+    if (grown == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    path->nodes = grown;
+  }
+  path->nodes[path->size++] = node;
+}
+
+/*
+ * Zkopíruje uzly cesty zdola nahoru tak, že místo podstromu ve směru klíče
+ * key odkazují na subtree, a vrátí kořen nové verze. Cestu uvolní.
+ */
+static pbst_node_t *pbst_rebuild(pbst_path_t *path, int key,
+                                 pbst_node_t *subtree)
+{
+  for (int i = path->size - 1; i >= 0; i--) {
+    pbst_node_t *node = path->nodes[i];
+    if (key < node->key) {
+      subtree = pbst_node_create(node->key, pbst_value_retain(node->value),
+                                 subtree, pbst_retain(node->right));
+    } else {
+      subtree = pbst_node_create(node->key, pbst_value_retain(node->value),
+                                 pbst_retain(node->left), subtree);
+    }
+  }
+  free(path->nodes);
+  return subtree;
+}
+
+/*
+ * Vyhledání uzlu ve verzi stromu.
+ *
+ * Hodnota zůstává platná, dokud volající drží odkaz na prohledávanou verzi.
+ */
+bool pbst_search(pbst_node_t *tree, int key, bst_node_content_t **value)
+{
+  while (tree != NULL) {
+    if (key == tree->key) {
+      *value = &tree->value->content;
+      return true;
+    }
+    tree = key < tree->key ? tree->left : tree->right;
+  }
+  return false;
+}
+
+/*
+ * Vložení uzlu do verze stromu.
+ *
+ * Vrací novou verzi, ve které má klíč hodnotu value; původní verze se
+ * nemění. Nová verze přebírá vlastnictví hodnoty.
+ */
+pbst_node_t *pbst_insert(pbst_node_t *tree, int key, bst_node_content_t value)
+{
+  pbst_path_t path = {.nodes = NULL, .size = 0, .capacity = 0};
+  pbst_node_t *node = tree;
+  while (node != NULL && node->key != key) {
+    pbst_path_push(&path, node);
+    node = key < node->key ? node->left : node->right;
+  }
+  pbst_node_t *fresh;
+  if (node == NULL) {
+    fresh = pbst_node_create(key, pbst_value_create(value), NULL, NULL);
+  } else {
+    // the old value stays alive for the versions that still share it
+    fresh = pbst_node_create(key, pbst_value_create(value),
+                             pbst_retain(node->left), pbst_retain(node->right));
+  }
+  return pbst_rebuild(&path, key, fresh);
+}
+
+/*
+ * Kopie podstromu bez jeho nejpravějšího uzlu, který se uloží do rightmost.
+ */
+static pbst_node_t *pbst_without_rightmost(pbst_node_t *tree,
+                                           pbst_node_t **rightmost)
+{
+  pbst_path_t spine = {.nodes = NULL, .size = 0, .capacity = 0};
+  while (tree->right != NULL) {
+    pbst_path_push(&spine, tree);
+    tree = tree->right;
+  }
+  *rightmost = tree;
+  // every spine node is rebuilt with its right pointer replaced
+  return pbst_rebuild(&spine, tree->key, pbst_retain(tree->left));
+}
+
+/*
+ * Odstranění uzlu z verze stromu.
+ *
+ * Vrací novou verzi bez klíče key (nebo další odkaz na původní verzi, pokud
+ * v ní klíč není); původní verze se nemění.
+ */
+pbst_node_t *pbst_delete(pbst_node_t *tree, int key)
+{
+  pbst_path_t path = {.nodes = NULL, .size = 0, .capacity = 0};
+  pbst_node_t *node = tree;
+  while (node != NULL && node->key != key) {
+    pbst_path_push(&path, node);
+    node = key < node->key ? node->left : node->right;
+  }
+  if (node == NULL) {
+    free(path.nodes);
+    return pbst_retain(tree);
+  }
+  pbst_node_t *replacement;
+  if (node->left == NULL) {
+    replacement = pbst_retain(node->right);
+  } else if (node->right == NULL) {
+    replacement = pbst_retain(node->left);
+  } else {
+    // same as bst_delete: the node is replaced by the rightmost node of its
+    // left subtree
+    pbst_node_t *rightmost;
+    pbst_node_t *left = pbst_without_rightmost(node->left, &rightmost);
+    replacement = pbst_node_create(rightmost->key,
+                                   pbst_value_retain(rightmost->value), left,
+                                   pbst_retain(node->right));
+  }
+  return pbst_rebuild(&path, key, replacement);
+}
+
+/*
+ * Inorder průchod verzí stromu.
+ */
+void pbst_inorder(pbst_node_t *tree, pbst_visit_t visit, void *ctx)
+{
+  pbst_path_t stack = {.nodes = NULL, .size = 0, .capacity = 0};
+  while (tree != NULL || stack.size > 0) {
+    while (tree != NULL) {
+      pbst_path_push(&stack, tree);
+      tree = tree->left;
+    }
+    tree = stack.nodes[--stack.size];
+    visit(tree->key, &tree->value->content, ctx);
+    tree = tree->right;
+  }
+  free(stack.nodes);
+}
+
+/*
+ * Inicializace sdílené verze (prázdný strom).
+ */
+void pbst_init(pbst_t *handle)
+{
+  handle->root = NULL;
+  pthread_mutex_init(&handle->lock, NULL);
+}
+
+/*
+ * Zrušení sdílené verze. Snímky získané přes pbst_snapshot zůstávají
+ * platné, dokud je jejich držitelé neuvolní.
+ */
+void pbst_dispose(pbst_t *handle)
+{
+  pbst_release(handle->root);
+  handle->root = NULL;
+  pthread_mutex_destroy(&handle->lock);
+}
+
+/*
+ * Snímek aktuální verze v konstantním čase.
+ *
+ * Volající musí snímek uvolnit pomocí pbst_release.
+ */
+pbst_node_t *pbst_snapshot(pbst_t *handle)
+{
+  pthread_mutex_lock(&handle->lock);
+  pbst_node_t *tree = pbst_retain(handle->root);
+  pthread_mutex_unlock(&handle->lock);
+  return tree;
+}
+
+/*
+ * Vložení do sdílené verze.
+ *
+ * Zapisovatelé se navzájem vylučují, čtenáři vidí buď starou, nebo celou
+ * novou verzi.
+ */
+void pbst_commit_insert(pbst_t *handle, int key, bst_node_content_t value)
+{
+  pthread_mutex_lock(&handle->lock);
+  pbst_node_t *old = handle->root;
+  handle->root = pbst_insert(old, key, value);
+  pthread_mutex_unlock(&handle->lock);
+  pbst_release(old);
+}
+
+/*
+ * Odstranění ze sdílené verze.
+ */
+void pbst_commit_delete(pbst_t *handle, int key)
+{
+  pthread_mutex_lock(&handle->lock);
+  pbst_node_t *old = handle->root;
+  handle->root = pbst_delete(old, key);
+  pthread_mutex_unlock(&handle->lock);
+  pbst_release(old);
+}
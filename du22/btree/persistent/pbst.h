@@ -0,0 +1,56 @@
+/*
+ * Hlavičkový soubor pro perzistentní binární vyhledávací strom.
+ *
+ * Uzly se po vytvoření nikdy nemění. Vložení a odstranění zkopírují jen
+ * cestu od kořene k měněnému uzlu a vrátí kořen nové verze, která se
+ * zbytkem stromu sdílí všechny ostatní uzly. Starší verze zůstávají platné,
+ * dokud na ně někdo drží odkaz; uzly a hodnoty se uvolňují počítáním odkazů.
+ */
+
+#ifndef IAL_BTREE_PERSISTENT_H
+#define IAL_BTREE_PERSISTENT_H
+
+#include "../btree.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Hodnota sdílená mezi verzemi stromu
+typedef struct pbst_value {
+  atomic_int refs;            // počet uzlů, které hodnotu používají
+  bst_node_content_t content; // hodnota
+} pbst_value_t;
+
+// Neměnný uzel stromu
+typedef struct pbst_node {
+  int key;                   // klíč
+  pbst_value_t *value;       // hodnota
+  struct pbst_node *left;    // levý potomek
+  struct pbst_node *right;   // pravý potomek
+  atomic_int refs;           // počet rodičů a verzí, které uzel používají
+} pbst_node_t;
+
+// Sdílená verze stromu pro jednoho zapisovatele a libovolně čtenářů
+typedef struct pbst {
+  pbst_node_t *root;         // aktuální verze
+  pthread_mutex_t lock;      // chrání výměnu kořene
+} pbst_t;
+
+// Funkce volaná pro každou dvojici klíč/hodnota při průchodu
+typedef void (*pbst_visit_t)(int key, bst_node_content_t *content, void *ctx);
+
+pbst_node_t *pbst_retain(pbst_node_t *tree);
+void pbst_release(pbst_node_t *tree);
+
+bool pbst_search(pbst_node_t *tree, int key, bst_node_content_t **value);
+pbst_node_t *pbst_insert(pbst_node_t *tree, int key, bst_node_content_t value);
+pbst_node_t *pbst_delete(pbst_node_t *tree, int key);
+void pbst_inorder(pbst_node_t *tree, pbst_visit_t visit, void *ctx);
+
+void pbst_init(pbst_t *handle);
+void pbst_dispose(pbst_t *handle);
+pbst_node_t *pbst_snapshot(pbst_t *handle);
+void pbst_commit_insert(pbst_t *handle, int key, bst_node_content_t value);
+void pbst_commit_delete(pbst_t *handle, int key);
+
+#endif
@@ -0,0 +1,196 @@
+#include "pbst.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  void NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    pbst_node_t *test_tree = NULL;
+
+#define ENDTEST                                                                \
+  printf("\n");                                                                \
+  pbst_release(test_tree);                                                     \
+  }
+
+#define READERS 3
+const int writes = 20000;
+
+bst_node_content_t create_integer_content(int value)
+{
+  bst_node_content_t result = {
+    .type = INTEGER,
+    .value = malloc(sizeof(int))
+  };
+  *((int*)(result.value)) = value;
+  return result;
+}
+
+void print_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  printf(" %d:%d", key, *(int *)content->value);
+}
+
+void print_version(const char *name, pbst_node_t *tree)
+{
+  printf("%s:", name);
+  pbst_inorder(tree, print_visit, NULL);
+  printf("\n");
+}
+
+/*
+ * Nahradí verzi *tree novou verzí (stará se uvolní).
+ */
+void advance(pbst_node_t **tree, pbst_node_t *next)
+{
+  pbst_release(*tree);
+  *tree = next;
+}
+
+TEST(test_tree_versions, "Old versions survive inserts and deletes")
+int keys[] = {5, 3, 8, 1, 4, 7, 9};
+for (int i = 0; i < 7; i++) {
+  advance(&test_tree,
+          pbst_insert(test_tree, keys[i], create_integer_content(keys[i] * 10)));
+}
+pbst_node_t *v1 = pbst_retain(test_tree);
+advance(&test_tree, pbst_insert(test_tree, 6, create_integer_content(60)));
+pbst_node_t *v2 = pbst_retain(test_tree);
+advance(&test_tree, pbst_insert(test_tree, 4, create_integer_content(444)));
+pbst_node_t *v3 = pbst_retain(test_tree);
+advance(&test_tree, pbst_delete(test_tree, 5));
+advance(&test_tree, pbst_delete(test_tree, 1));
+print_version("v1", v1);
+print_version("v2", v2);
+print_version("v3", v3);
+print_version("v4", test_tree);
+printf("root v1 %d, v4 %d\n", v1->key, test_tree->key);
+// inserting 6 copies only the right path, inserting 4 only the left one
+printf("v1/v2 share left subtree: %s\n", v1->left == v2->left ? "yes" : "no");
+printf("v2/v3 share right subtree: %s\n", v2->right == v3->right ? "yes" : "no");
+printf("v2/v3 share left subtree: %s\n", v2->left == v3->left ? "yes" : "no");
+pbst_release(v1);
+pbst_release(v2);
+pbst_release(v3);
+ENDTEST
+
+TEST(test_tree_search_versions, "Search sees the value of its own version")
+advance(&test_tree, pbst_insert(test_tree, 2, create_integer_content(20)));
+pbst_node_t *before = pbst_retain(test_tree);
+advance(&test_tree, pbst_insert(test_tree, 2, create_integer_content(22)));
+advance(&test_tree, pbst_delete(test_tree, 3));
+bst_node_content_t *value;
+printf("before: 2 -> %d\n",
+       pbst_search(before, 2, &value) ? *(int *)value->value : -1);
+printf("after: 2 -> %d\n",
+       pbst_search(test_tree, 2, &value) ? *(int *)value->value : -1);
+advance(&test_tree, pbst_delete(test_tree, 2));
+printf("deleted: 2 -> %s\n", pbst_search(test_tree, 2, &value) ? "found" : "none");
+printf("before still: 2 -> %d\n",
+       pbst_search(before, 2, &value) ? *(int *)value->value : -1);
+pbst_release(before);
+ENDTEST
+
+TEST(test_tree_delete_inner, "Delete nodes with two children from a shared tree")
+int keys[] = {50, 30, 70, 20, 40, 60, 80, 35, 45, 43};
+for (int i = 0; i < 10; i++) {
+  advance(&test_tree,
+          pbst_insert(test_tree, keys[i], create_integer_content(keys[i])));
+}
+pbst_node_t *original = pbst_retain(test_tree);
+advance(&test_tree, pbst_delete(test_tree, 50));
+advance(&test_tree, pbst_delete(test_tree, 30));
+print_version("original", original);
+print_version("deleted", test_tree);
+printf("new root %d\n", test_tree->key);
+pbst_release(original);
+ENDTEST
+
+typedef struct {
+  pbst_t *handle;
+  int snapshots;
+  int consistent;
+} reader_t;
+
+typedef struct {
+  int count;
+  int last;
+  bool sorted;
+} check_t;
+
+void check_visit(int key, bst_node_content_t *content, void *ctx)
+{
+  check_t *check = ctx;
+  if (check->count > 0 && key <= check->last) {
+    check->sorted = false;
+  }
+  check->last = key;
+  check->count++;
+}
+
+void *reader(void *arg)
+{
+  reader_t *state = arg;
+  for (int i = 0; i < 200; i++) {
+    pbst_node_t *snapshot = pbst_snapshot(state->handle);
+    // a snapshot never changes, so two scans must agree
+    check_t first = {.count = 0, .last = 0, .sorted = true};
+    check_t second = {.count = 0, .last = 0, .sorted = true};
+    pbst_inorder(snapshot, check_visit, &first);
+    pbst_inorder(snapshot, check_visit, &second);
+    if (first.sorted && first.count == second.count) {
+      state->consistent++;
+    }
+    state->snapshots++;
+    pbst_release(snapshot);
+  }
+  return NULL;
+}
+
+void test_tree_snapshots()
+{
+  printf("[test_tree_snapshots] Readers scan snapshots while a writer commits\n");
+  pbst_t handle;
+  pbst_init(&handle);
+  pthread_t threads[READERS];
+  reader_t readers[READERS];
+  for (int i = 0; i < READERS; i++) {
+    readers[i] = (reader_t){.handle = &handle, .snapshots = 0, .consistent = 0};
+    pthread_create(&threads[i], NULL, reader, &readers[i]);
+  }
+  for (int i = 0; i < writes; i++) {
+    int key = (int)((long)i * 7919 % writes);
+    pbst_commit_insert(&handle, key, create_integer_content(key));
+    if (i % 4 == 3) {
+      pbst_commit_delete(&handle, key);
+    }
+  }
+  for (int i = 0; i < READERS; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  int snapshots = 0, consistent = 0;
+  for (int i = 0; i < READERS; i++) {
+    snapshots += readers[i].snapshots;
+    consistent += readers[i].consistent;
+  }
+  pbst_node_t *final = pbst_snapshot(&handle);
+  check_t check = {.count = 0, .last = 0, .sorted = true};
+  pbst_inorder(final, check_visit, &check);
+  pbst_release(final);
+  printf("consistent snapshots: %d of %d\n", consistent, snapshots);
+  printf("final: count %d, sorted %s\n", check.count, check.sorted ? "yes" : "no");
+  pbst_dispose(&handle);
+  printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+  printf("Persistent Binary Search Tree - testing script\n");
+  printf("----------------------------------------------\n");
+  printf("\n");
+  test_tree_versions();
+  test_tree_search_versions();
+  test_tree_delete_inner();
+  test_tree_snapshots();
+  printf("\n");
+  return 0;
+}
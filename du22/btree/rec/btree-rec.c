@@ -9,6 +9,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/*
+ * Hloubka, od které vyhledání, vkládání, mazání, dispose, průchody
+ * a bst_range zpracují zbytek podstromu bez rekurze, aby ani zdegenerovaný
+ * strom nevyčerpal zásobník volání, a to při jakékoli úrovni optimalizace.
+ */
+#ifndef BST_REC_DEPTH_LIMIT
+#define BST_REC_DEPTH_LIMIT 4096
+#endif
+
 /*
  * Inicializace stromu.
  *
@@ -23,16 +32,17 @@ void bst_init(bst_node_t **tree)
 }
 
 /*
- * Vyhledání uzlu v stromu.
- *
- * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
- * ukazatel na obsah daného uzlu. V opačném případě funkce vrátí hodnotu false a proměnná
- * value zůstává nezměněná.
- *
- * Funkci implementujte rekurzivně bez použité vlastních pomocných funkcí.
+ * Rekurzivní vyhledání v hloubce depth. Od hloubky BST_REC_DEPTH_LIMIT se
+ * zbytek cesty projde cyklem.
  */
-bool bst_search(bst_node_t *tree, char key, bst_node_content_t **value)
+static bool bst_search_bounded(bst_node_t *tree, int key,
+                               bst_node_content_t **value, int depth)
 {
+  if (depth == BST_REC_DEPTH_LIMIT) { // the rest of the path by a loop
+    while (tree != NULL && tree->key != key) {
+      tree = key < tree->key ? tree->left : tree->right;
+    }
+  }
   if (!tree){ // basecase if the tree is empty
     return false;
   }
@@ -45,29 +55,45 @@ bool bst_search(bst_node_t *tree, char key, bst_node_content_t **value)
     if (tree->left == NULL){
       return false;
     }
-    return bst_search(tree->left, key, value);
+    return bst_search_bounded(tree->left, key, value, depth + 1);
   }
   else{ // else we search right subtree
     if(tree->right == NULL){
       return false;
     }
-    return bst_search(tree->right, key, value);
+    return bst_search_bounded(tree->right, key, value, depth + 1);
   }
 }
 
 /*
- * Vložení uzlu do stromu.
+ * Vyhledání uzlu v stromu.
  *
- * Pokud uzel se zadaným klíčem už ve stromu existuje, nahraďte jeho hodnotu.
- * Jinak vložte nový listový uzel.
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * ukazatel na obsah daného uzlu. V opačném případě funkce vrátí hodnotu false a proměnná
+ * value zůstává nezměněná.
  *
- * Výsledný strom musí splňovat podmínku vyhledávacího stromu — levý podstrom
- * uzlu obsahuje jenom menší klíče, pravý větší.
+ * Funkce je implementovaná rekurzivně v bst_search_bounded.
+ */
+bool bst_search(bst_node_t *tree, int key, bst_node_content_t **value)
+{
+  return bst_search_bounded(tree, key, value, 0);
+}
+
+/*
+ * Sestup pro bst_insert v hloubce depth.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Velikosti uzlů na cestě se zvětšují už při sestupu (pokud grows platí).
+ * Od hloubky BST_REC_DEPTH_LIMIT se zbytek cesty projde cyklem.
  */
-void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
+static void bst_insert_descend(bst_node_t **tree, int key,
+                               bst_node_content_t value, bool grows, int depth)
 {
+  if (depth == BST_REC_DEPTH_LIMIT) { // the rest of the path by a loop
+    while (*tree != NULL && (*tree)->key != key) {
+      BST_ADJUST_SIZE(*tree, grows);
+      tree = key < (*tree)->key ? &((*tree)->left) : &((*tree)->right);
+    }
+  }
   if (*tree == NULL){ // basecase: inserting a new node
     *tree = malloc(sizeof(bst_node_t)); // alloc a new node
     if (*tree == NULL){ 
@@ -77,6 +103,7 @@ void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
     (*tree)->content = value;
     (*tree)->left = NULL;
     (*tree)->right = NULL;
+    BST_UPDATE_SIZE(*tree);
     return;
   }
 
@@ -86,37 +113,62 @@ void bst_insert(bst_node_t **tree, char key, bst_node_content_t value)
       (*tree)->content.value = NULL;
     }
     (*tree)->content = value;
+    return;
   }
-  else if (key < (*tree)->key){ // we look in the left subtree
-    bst_insert(&((*tree)->left), key, value);
+
+  BST_ADJUST_SIZE(*tree, grows); // the new node ends up below
+  if (key < (*tree)->key){ // we look in the left subtree
+    bst_insert_descend(&((*tree)->left), key, value, grows, depth + 1);
   }
   else{ // else we look in the right subtree
-    bst_insert(&((*tree)->right), key, value);
+    bst_insert_descend(&((*tree)->right), key, value, grows, depth + 1);
   }
 }
 
 /*
- * Pomocná funkce která nahradí uzel nejpravějším potomkem.
- *
- * Klíč a hodnota uzlu target budou nahrazeny klíčem a hodnotou nejpravějšího
- * uzlu podstromu tree. Nejpravější potomek bude odstraněný. Funkce korektně
- * uvolní všechny alokované zdroje odstraněného uzlu.
+ * Vložení uzlu do stromu.
  *
- * Funkce předpokládá, že hodnota tree není NULL.
+ * Pokud uzel se zadaným klíčem už ve stromu existuje, nahraďte jeho hodnotu.
+ * Jinak vložte nový listový uzel.
  *
- * Tato pomocná funkce bude využitá při implementaci funkce bst_delete.
+ * Výsledný strom musí splňovat podmínku vyhledávacího stromu — levý podstrom
+ * uzlu obsahuje jenom menší klíče, pravý větší.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce je implementovaná rekurzivně v bst_insert_descend.
  */
-void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
+void bst_insert(bst_node_t **tree, int key, bst_node_content_t value)
+{
+  bool grows = true;
+#ifdef BST_ORDER_STATISTICS
+  // the sizes on the path change only if a new node is added
+  bst_node_content_t *existing;
+  grows = !bst_search(*tree, key, &existing);
+#endif
+  bst_insert_descend(tree, key, value, grows, 0);
+}
+
+/*
+ * Rekurzivní nahrazení nejpravějším uzlem v hloubce depth. Od hloubky
+ * BST_REC_DEPTH_LIMIT se zbytek pravého okraje projde cyklem.
+ */
+static void bst_replace_by_rightmost_bounded(bst_node_t *target,
+                                             bst_node_t **tree, int depth)
 {
   // if tree is null or empty
   if (!tree || *tree == NULL){
     return;
   }
-  
+
+  if (depth == BST_REC_DEPTH_LIMIT) { // the rest of the spine by a loop
+    while ((*tree)->right != NULL) {
+      BST_ADJUST_SIZE(*tree, -1);
+      tree = &((*tree)->right);
+    }
+  }
+
   if ((*tree)->right != NULL){ // find the rightmost node
-    bst_replace_by_rightmost(target, &((*tree)->right));
+    BST_ADJUST_SIZE(*tree, -1); // the right subtree loses a node
+    bst_replace_by_rightmost_bounded(target, &((*tree)->right), depth + 1);
   }else{
     if (target->content.value != NULL){
       free(target->content.value);
@@ -135,31 +187,51 @@ void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
 }
 
 /*
- * Odstranění uzlu ze stromu.
+ * Pomocná funkce která nahradí uzel nejpravějším potomkem.
  *
- * Pokud uzel se zadaným klíčem neexistuje, funkce nic nedělá.
- * Pokud má odstraněný uzel jeden podstrom, zdědí ho rodič odstraněného uzlu.
- * Pokud má odstraněný uzel oba podstromy, je nahrazený nejpravějším uzlem
- * levého podstromu. Nejpravější uzel nemusí být listem.
+ * Klíč a hodnota uzlu target budou nahrazeny klíčem a hodnotou nejpravějšího
+ * uzlu podstromu tree. Nejpravější potomek bude odstraněný. Funkce korektně
+ * uvolní všechny alokované zdroje odstraněného uzlu.
  *
- * Funkce korektně uvolní všechny alokované zdroje odstraněného uzlu.
+ * Funkce předpokládá, že hodnota tree není NULL.
  *
- * Funkci implementujte rekurzivně pomocí bst_replace_by_rightmost a bez
- * použití vlastních pomocných funkcí.
+ * Tato pomocná funkce bude využitá při implementaci funkce bst_delete.
+ *
+ * Funkce je implementovaná rekurzivně v bst_replace_by_rightmost_bounded.
  */
-void bst_delete(bst_node_t **tree, char key)
+void bst_replace_by_rightmost(bst_node_t *target, bst_node_t **tree)
 {
+  bst_replace_by_rightmost_bounded(target, tree, 0);
+}
+
+/*
+ * Sestup pro bst_delete v hloubce depth.
+ *
+ * S udržováním velikostí podstromů smí být volána jen pro klíč, který ve
+ * stromu je; velikosti se pak zmenšují už při sestupu. Od hloubky
+ * BST_REC_DEPTH_LIMIT se zbytek cesty projde cyklem.
+ */
+static void bst_delete_descend(bst_node_t **tree, int key, int depth)
+{
+  if (depth == BST_REC_DEPTH_LIMIT) { // the rest of the path by a loop
+    while (*tree != NULL && (*tree)->key != key) {
+      BST_ADJUST_SIZE(*tree, -1);
+      tree = key < (*tree)->key ? &((*tree)->left) : &((*tree)->right);
+    }
+  }
   if (*tree == NULL) {
     return; // key not found
   }
 
   // search left subtree
   if (key < (*tree)->key) {
-    bst_delete(&((*tree)->left), key);
+    BST_ADJUST_SIZE(*tree, -1); // the key is known to be below
+    bst_delete_descend(&((*tree)->left), key, depth + 1);
   }
   // search right subtree
   else if (key > (*tree)->key) {
-    bst_delete(&((*tree)->right), key);
+    BST_ADJUST_SIZE(*tree, -1);
+    bst_delete_descend(&((*tree)->right), key, depth + 1);
   }
   else { // key found
     if ((*tree)->left == NULL && (*tree)->right == NULL) { // leaf node
@@ -181,12 +253,90 @@ void bst_delete(bst_node_t **tree, char key)
     }
     else { // both children
       if ((*tree)->left != NULL){
-        bst_replace_by_rightmost(*tree, &((*tree)->left));
+        bst_replace_by_rightmost_bounded(*tree, &((*tree)->left), depth + 1);
+        BST_UPDATE_SIZE(*tree);
       }
     }
   }
 }
 
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Pokud uzel se zadaným klíčem neexistuje, funkce nic nedělá.
+ * Pokud má odstraněný uzel jeden podstrom, zdědí ho rodič odstraněného uzlu.
+ * Pokud má odstraněný uzel oba podstromy, je nahrazený nejpravějším uzlem
+ * levého podstromu. Nejpravější uzel nemusí být listem.
+ *
+ * Funkce korektně uvolní všechny alokované zdroje odstraněného uzlu.
+ *
+ * Funkce je implementovaná rekurzivně v bst_delete_descend pomocí
+ * bst_replace_by_rightmost_bounded.
+ */
+void bst_delete(bst_node_t **tree, int key)
+{
+#ifdef BST_ORDER_STATISTICS
+  bst_node_content_t *existing;
+  if (!bst_search(*tree, key, &existing)) {
+    return; // key not found, no sizes change
+  }
+#endif
+  bst_delete_descend(tree, key, 0);
+}
+
+/*
+ * Zrušení podstromu bez rekurze a bez pomocné paměti.
+ *
+ * Rotacemi doprava se levý potomek přesouvá nad uzel, dokud nějaký má;
+ * uzel bez levého potomka se uvolní a pokračuje se jeho pravým podstromem.
+ */
+static void bst_dispose_rotating(bst_node_t **tree)
+{
+  bst_node_t *node = *tree;
+  while (node != NULL) {
+    if (node->left != NULL) { // rotate right
+      bst_node_t *left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
+    }
+    else {
+      bst_node_t *next = node->right;
+      free(node->content.value);
+      free(node);
+      node = next;
+    }
+  }
+  *tree = NULL;
+}
+
+/*
+ * Rekurzivní zrušení podstromu v hloubce depth.
+ *
+ * Uzel se uvolní hned po levém podstromu a pravý podstrom se ruší koncovým
+ * voláním. Od hloubky BST_REC_DEPTH_LIMIT se zbytek zruší rotacemi.
+ */
+static void bst_dispose_bounded(bst_node_t **tree, int depth)
+{
+  if (*tree == NULL) {
+    return;
+  }
+  if (depth == BST_REC_DEPTH_LIMIT) {
+    bst_dispose_rotating(tree);
+    return;
+  }
+  // dispose left tree by recursion
+  bst_dispose_bounded(&((*tree)->left), depth + 1);
+
+  // freeing the content and the node, the right tree takes its place
+  bst_node_t *temp_node = *tree;
+  *tree = temp_node->right;
+  free(temp_node->content.value);
+  free(temp_node);
+
+  bst_dispose_bounded(tree, depth + 1);
+}
+
 /*
  * Zrušení celého stromu.
  *
@@ -194,25 +344,149 @@ void bst_delete(bst_node_t **tree, char key)
  * inicializaci. Funkce korektně uvolní všechny alokované zdroje rušených
  * uzlů.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce je implementovaná rekurzivně v bst_dispose_bounded.
  */
 void bst_dispose(bst_node_t **tree)
 {
-  if(*tree != NULL){
-    // dispose left and right trees by recursion
-    bst_dispose(&((*tree)->left));
-    bst_dispose(&((*tree)->right));
+  bst_dispose_bounded(tree, 0);
+}
 
-    // freeing the content
-    if((*tree)->content.value != NULL){
-      free((*tree)->content.value);
-      (*tree)->content.value = NULL;
+/*
+ * Sestup pro bst_lower_bound a bst_upper_bound v hloubce depth.
+ *
+ * Dosud nejlepší kandidát se předává v best. Při strict hledá klíč ostře
+ * větší než key. Od hloubky BST_REC_DEPTH_LIMIT se zbytek cesty projde
+ * cyklem.
+ */
+static bst_node_t *bst_bound_descend(bst_node_t *tree, int key, bool strict,
+                                     bst_node_t *best, int depth)
+{
+  if (depth == BST_REC_DEPTH_LIMIT) { // the rest of the path by a loop
+    while (tree != NULL) {
+      if (tree->key < key || (strict && tree->key == key)) {
+        tree = tree->right;
+      }
+      else {
+        best = tree;
+        tree = tree->left;
+      }
     }
+  }
+  if (tree == NULL) {
+    return best;
+  }
+  if (tree->key < key || (strict && tree->key == key)) {
+    // nothing on the left qualifies either
+    return bst_bound_descend(tree->right, key, strict, best, depth + 1);
+  }
+  // this node qualifies, a better candidate can only be on the left
+  return bst_bound_descend(tree->left, key, strict, tree, depth + 1);
+}
 
-    // freeing the node
-    bst_node_t *temp_node = *tree;
-    free(temp_node);
-    *tree = NULL; // set to null
+/*
+ * Nalezení uzlu s nejmenším klíčem větším nebo rovným key.
+ *
+ * Pokud takový uzel neexistuje, funkce vrací NULL.
+ *
+ * Funkce je implementovaná rekurzivně v bst_bound_descend.
+ */
+bst_node_t *bst_lower_bound(bst_node_t *tree, int key)
+{
+  return bst_bound_descend(tree, key, false, NULL, 0);
+}
+
+/*
+ * Nalezení uzlu s nejmenším klíčem ostře větším než key.
+ *
+ * Pokud takový uzel neexistuje, funkce vrací NULL.
+ *
+ * Funkce je implementovaná rekurzivně v bst_bound_descend.
+ */
+bst_node_t *bst_upper_bound(bst_node_t *tree, int key)
+{
+  return bst_bound_descend(tree, key, true, NULL, 0);
+}
+
+/*
+ * Rekurzivní průchod intervalem v hloubce depth.
+ *
+ * Od hloubky BST_REC_DEPTH_LIMIT pokračuje inorder kurzorem, který má
+ * zásobník na haldě.
+ */
+static void bst_range_bounded(bst_node_t *tree, int low, int high,
+                              bst_visit_t visit, void *ctx, int depth)
+{
+  if (tree == NULL) {
+    return;
+  }
+  if (depth == BST_REC_DEPTH_LIMIT) {
+    bst_cursor_t cursor;
+    bst_cursor_init(&cursor, tree, BST_INORDER);
+    bst_cursor_seek(&cursor, low);
+    bst_node_t *node;
+    while ((node = bst_cursor_next(&cursor)) != NULL && node->key < high) {
+      visit(node, ctx);
+    }
+    bst_cursor_dispose(&cursor);
+    return;
+  }
+  if (low < tree->key) { // the left subtree may still reach into the range
+    bst_range_bounded(tree->left, low, high, visit, ctx, depth + 1);
+  }
+  if (low <= tree->key && tree->key < high) {
+    visit(tree, ctx);
+  }
+  if (tree->key < high) { // the right subtree may still reach into the range
+    bst_range_bounded(tree->right, low, high, visit, ctx, depth + 1);
+  }
+}
+
+/*
+ * Průchod uzly s klíči z intervalu [low, high) ve vzestupném pořadí.
+ *
+ * Pro každý uzel v intervalu zavolá funkci visit. Podstromy, které leží celé
+ * mimo interval, se neprochází, složitost je O(h + k) pro k nalezených uzlů.
+ *
+ * Funkce je implementovaná rekurzivně v bst_range_bounded.
+ */
+void bst_range(bst_node_t *tree, int low, int high, bst_visit_t visit, void *ctx)
+{
+  bst_range_bounded(tree, low, high, visit, ctx, 0);
+}
+
+/*
+ * Rekurzivní průchod podstromem v pořadí order v hloubce depth.
+ *
+ * Od hloubky BST_REC_DEPTH_LIMIT projde zbytek podstromu kurzorem, který
+ * vrací uzly ve stejném pořadí jako rekurze.
+ */
+static void bst_traverse_bounded(bst_node_t *tree, bst_items_t *items,
+                                 bst_order_t order, int depth)
+{
+  // if the tree is empty
+  if (tree == NULL){
+    return;
+  }
+  if (depth == BST_REC_DEPTH_LIMIT){
+    bst_cursor_t cursor;
+    bst_cursor_init(&cursor, tree, order);
+    bst_node_t *node;
+    while ((node = bst_cursor_next(&cursor)) != NULL){
+      bst_add_node_to_items(node, items);
+    }
+    bst_cursor_dispose(&cursor);
+    return;
+  }
+  if (order == BST_PREORDER){
+    bst_add_node_to_items(tree, items);
+  }
+  bst_traverse_bounded(tree->left, items, order, depth + 1);
+  if (order == BST_INORDER){
+    bst_add_node_to_items(tree, items);
+  }
+  bst_traverse_bounded(tree->right, items, order, depth + 1);
+  if (order == BST_POSTORDER){
+    bst_add_node_to_items(tree, items);
   }
 }
 
@@ -221,16 +495,12 @@ void bst_dispose(bst_node_t **tree)
  *
  * Pro aktuálně zpracovávaný uzel zavolejte funkci bst_add_node_to_items.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce je implementovaná rekurzivně v bst_traverse_bounded.
  */
 void bst_preorder(bst_node_t *tree, bst_items_t *items)
 {
-  // if the tree is not empty
-  if (tree != NULL){
-    bst_add_node_to_items(tree, items);
-    bst_preorder(tree->left, items);
-    bst_preorder(tree->right, items);
-  }
+  BST_ITEMS_RESERVE_TREE(items, tree);
+  bst_traverse_bounded(tree, items, BST_PREORDER, 0);
 }
 
 /*
@@ -238,16 +508,12 @@ void bst_preorder(bst_node_t *tree, bst_items_t *items)
  *
  * Pro aktuálně zpracovávaný uzel zavolejte funkci bst_add_node_to_items.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce je implementovaná rekurzivně v bst_traverse_bounded.
  */
 void bst_inorder(bst_node_t *tree, bst_items_t *items)
 {
-  // if the tree is not empty
-  if (tree != NULL){
-    bst_inorder(tree->left, items);
-    bst_add_node_to_items(tree, items);
-    bst_inorder(tree->right, items);
-  }
+  BST_ITEMS_RESERVE_TREE(items, tree);
+  bst_traverse_bounded(tree, items, BST_INORDER, 0);
 }
 
 /*
@@ -255,14 +521,10 @@ void bst_inorder(bst_node_t *tree, bst_items_t *items)
  *
  * Pro aktuálně zpracovávaný uzel zavolejte funkci bst_add_node_to_items.
  *
- * Funkci implementujte rekurzivně bez použití vlastních pomocných funkcí.
+ * Funkce je implementovaná rekurzivně v bst_traverse_bounded.
  */
 void bst_postorder(bst_node_t *tree, bst_items_t *items)
 {
-  // if the tree is not empty
-  if (tree != NULL){
-    bst_postorder(tree->left, items);
-    bst_postorder(tree->right, items);
-    bst_add_node_to_items(tree, items);
-  }
+  BST_ITEMS_RESERVE_TREE(items, tree);
+  bst_traverse_bounded(tree, items, BST_POSTORDER, 0);
 }
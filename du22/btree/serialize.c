@@ -0,0 +1,281 @@
+/*
+ * Binární uložení a načtení binárního vyhledávacího stromu
+ *
+ * Uzly se zapisují v pořadí preorder spolu s bity, které říkají, zda má uzel
+ * levý a pravý podstrom. Z toho jde strom při čtení postavit v jednom
+ * průchodu v O(n) bez porovnávání klíčů a bez vyvažování: čtenář si drží
+ * zásobník míst (ukazatelů na potomky), kam patří další uzly.
+ */
+
+#include "serialize.h"
+#include "character.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char bst_magic[4] = {'B', 'S', 'T', '1'};
+
+// node flags
+#define BST_HAS_LEFT 0x01
+#define BST_HAS_RIGHT 0x02
+#define BST_NULL_VALUE 0x04
+#define BST_TYPE_SHIFT 4
+
+static bool bst_write_varint(FILE *stream, uint64_t value)
+{
+  while (value >= 0x80) {
+    if (putc((int)(value & 0x7f) | 0x80, stream) == EOF) {
+      return false;
+    }
+    value >>= 7;
+  }
+  return putc((int)value, stream) != EOF;
+}
+
+static bool bst_read_varint(FILE *stream, uint64_t *value)
+{
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = getc(stream);
+    if (byte == EOF) {
+      return false;
+    }
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false; // too long
+}
+
+// zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+static bool bst_write_int(FILE *stream, int value)
+{
+  int64_t wide = value;
+  return bst_write_varint(stream,
+                          ((uint64_t)wide << 1) ^ (uint64_t)(wide >> 63));
+}
+
+static bool bst_read_int(FILE *stream, int *value)
+{
+  uint64_t raw;
+  if (!bst_read_varint(stream, &raw)) {
+    return false;
+  }
+  int64_t wide = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+  if (wide < INT_MIN || wide > INT_MAX) {
+    return false;
+  }
+  *value = (int)wide;
+  return true;
+}
+
+static bool bst_write_content(FILE *stream, bst_node_content_t *content)
+{
+  switch (content->type) {
+  case INTEGER:
+    return bst_write_int(stream, *(int *)content->value);
+
+  case CHARACTER_T: {
+    character_t *character = content->value;
+    size_t length = character->name != NULL ? strlen(character->name) : 0;
+    // the length is stored plus one, zero marks a NULL name
+    return bst_write_varint(stream,
+                            character->name != NULL ? length + 1 : 0) &&
+           fwrite(character->name, 1, length, stream) == length &&
+           putc(character->character_class, stream) != EOF &&
+           putc(character->level, stream) != EOF;
+  }
+  }
+  return false;
+}
+
+/*
+ * Načtení hodnoty. Postava se alokuje v jednom bloku i se jménem, aby ji
+ * bst_delete a bst_dispose uvolnily jediným free.
+ */
+static bool bst_read_content(FILE *stream, bst_node_content_t *content)
+{
+  switch (content->type) {
+  case INTEGER: {
+    int *value = malloc(sizeof(int));
+    if (value == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    content->value = value;
+    return bst_read_int(stream, value);
+  }
+
+  case CHARACTER_T: {
+    uint64_t stored;
+    if (!bst_read_varint(stream, &stored) || stored > INT_MAX) {
+      return false;
+    }
+    size_t length = stored > 0 ? stored - 1 : 0;
+    character_t *character = malloc(sizeof(character_t) + length + 1);
+    if (character == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    content->value = character;
+    character->name = stored > 0 ? (char *)(character + 1) : NULL;
+    if (fread(character + 1, 1, length, stream) != length) {
+      return false;
+    }
+    ((char *)(character + 1))[length] = '\0';
+    int class = getc(stream);
+    int level = getc(stream);
+    if (class == EOF || level == EOF) {
+      return false;
+    }
+    character->character_class = class;
+    character->level = level;
+    return true;
+  }
+  }
+  return false;
+}
+
+/*
+ * Uložení stromu do proudu stream.
+ *
+ * Funkce vrací false, pokud zápis selže nebo strom obsahuje hodnotu
+ * neznámého typu.
+ */
+bool bst_serialize(bst_node_t *tree, FILE *stream)
+{
+  uint64_t count = 0;
+  bst_cursor_t cursor;
+#ifdef BST_ORDER_STATISTICS
+  count = bst_size(tree);
+#else
+  bst_cursor_init(&cursor, tree, BST_PREORDER);
+  while (bst_cursor_next(&cursor) != NULL) {
+    count++;
+  }
+  bst_cursor_dispose(&cursor);
+#endif
+
+  bool ok = fwrite(bst_magic, 1, sizeof(bst_magic), stream) ==
+                sizeof(bst_magic) &&
+            bst_write_varint(stream, count);
+
+  bst_cursor_init(&cursor, tree, BST_PREORDER);
+  bst_node_t *node;
+  while (ok && (node = bst_cursor_next(&cursor)) != NULL) {
+    int flags = node->content.type << BST_TYPE_SHIFT;
+    if (node->left != NULL) {
+      flags |= BST_HAS_LEFT;
+    }
+    if (node->right != NULL) {
+      flags |= BST_HAS_RIGHT;
+    }
+    if (node->content.value == NULL) {
+      flags |= BST_NULL_VALUE;
+    }
+    ok = putc(flags, stream) != EOF && bst_write_int(stream, node->key) &&
+         (node->content.value == NULL ||
+          bst_write_content(stream, &node->content));
+  }
+  bst_cursor_dispose(&cursor);
+  return ok;
+}
+
+// Místo, kam patří další načtený uzel, s povoleným intervalem klíčů
+typedef struct bst_slot {
+  bst_node_t **link;
+  int64_t low;   // exclusive
+  int64_t high;  // exclusive
+} bst_slot_t;
+
+/*
+ * Načtení stromu z proudu stream.
+ *
+ * Strom se postaví přesně v uloženém tvaru, uzly se alokují v pořadí
+ * preorder. Pokud data nejsou platná (chybí, nedodržují uspořádání klíčů,
+ * neznámý typ hodnoty), funkce uvolní rozpracovaný strom, nastaví *tree na
+ * NULL a vrátí false.
+ */
+bool bst_deserialize(bst_node_t **tree, FILE *stream)
+{
+  *tree = NULL;
+  char magic[sizeof(bst_magic)];
+  uint64_t count;
+  if (fread(magic, 1, sizeof(magic), stream) != sizeof(magic) ||
+      memcmp(magic, bst_magic, sizeof(magic)) != 0 ||
+      !bst_read_varint(stream, &count)) {
+    return false;
+  }
+
+  int size = 0, capacity = 64;
+  bst_slot_t *stack = malloc(capacity * sizeof(bst_slot_t));
+  if (stack == NULL) {
+    exit(EXIT_FAILURE);
+  }
+  if (count > 0) {
+    stack[size++] =
+        (bst_slot_t){.link = tree, .low = INT64_MIN, .high = INT64_MAX};
+  }
+
+  bool ok = true;
+  uint64_t read = 0;
+  while (ok && size > 0) {
+    bst_slot_t slot = stack[--size];
+    int flags = getc(stream);
+    int key;
+    if (flags == EOF || !bst_read_int(stream, &key) || key <= slot.low ||
+        key >= slot.high || ++read > count) {
+      ok = false;
+      break;
+    }
+    bst_node_t *node = malloc(sizeof(bst_node_t));
+    if (node == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    node->key = key;
+    node->content.type = flags >> BST_TYPE_SHIFT;
+    node->content.value = NULL;
+    node->left = NULL;
+    node->right = NULL;
+    *slot.link = node; // linked first, so a failure below frees it too
+    if ((flags & BST_NULL_VALUE) == 0) {
+      ok = bst_read_content(stream, &node->content);
+    }
+
+    // the left subtree follows first in preorder, so it goes on top
+    if (size + 2 > capacity) {
+      capacity *= 2;
+      bst_slot_t *grown = realloc(stack, capacity * sizeof(bst_slot_t));
+      if (grown == NULL) {
+        exit(EXIT_FAILURE);
+      }
+      stack = grown;
+    }
+    if (flags & BST_HAS_RIGHT) {
+      stack[size++] =
+          (bst_slot_t){.link = &node->right, .low = key, .high = slot.high};
+    }
+    if (flags & BST_HAS_LEFT) {
+      stack[size++] =
+          (bst_slot_t){.link = &node->left, .low = slot.low, .high = key};
+    }
+  }
+  free(stack);
+
+  if (!ok || read != count) {
+    bst_dispose(tree);
+    return false;
+  }
+
+#ifdef BST_ORDER_STATISTICS
+  // sizes need the children first, so they are filled in postorder
+  bst_cursor_t cursor;
+  bst_cursor_init(&cursor, *tree, BST_POSTORDER);
+  bst_node_t *node;
+  while ((node = bst_cursor_next(&cursor)) != NULL) {
+    BST_UPDATE_SIZE(node);
+  }
+  bst_cursor_dispose(&cursor);
+#endif
+  return true;
+}
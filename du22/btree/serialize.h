@@ -0,0 +1,20 @@
+/*
+ * Hlavičkový soubor pro binární uložení a načtení binárního vyhledávacího
+ * stromu.
+ *
+ * Formát: hlavička "BST1", počet uzlů a uzly v pořadí preorder. Každý uzel
+ * začíná bajtem příznaků (má levý/pravý podstrom, hodnota je NULL, typ
+ * hodnoty), následuje klíč a hodnota. Celá čísla se ukládají jako varint
+ * se zigzag kódováním, takže malé klíče zaberou jeden bajt.
+ */
+
+#ifndef IAL_BTREE_SERIALIZE_H
+#define IAL_BTREE_SERIALIZE_H
+
+#include "btree.h"
+#include <stdio.h>
+
+bool bst_serialize(bst_node_t *tree, FILE *stream);
+bool bst_deserialize(bst_node_t **tree, FILE *stream);
+
+#endif
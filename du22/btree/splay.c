@@ -0,0 +1,225 @@
+/*
+ * Splay varianta binárního vyhledávacího stromu (top-down splay podle
+ * Sleatora a Tarjana)
+ */
+
+#include "splay.h"
+#include <limits.h>
+#include <stdlib.h>
+
+/*
+ * Přesune do kořene uzel s klíčem key, nebo poslední uzel na cestě k němu
+ * (nejbližší menší nebo větší klíč), a vrátí nový kořen.
+ *
+ * Uzly menší než key se během sestupu věší na pravý okraj levé části
+ * (header.right), větší na levý okraj pravé části (header.left). Dva kroky
+ * stejným směrem se nejdřív srovnají rotací (zig-zig), čímž se cesta
+ * zkracuje zhruba na polovinu.
+ */
+bst_node_t *bst_splay(bst_node_t *tree, int key)
+{
+  if (tree == NULL) {
+    return NULL;
+  }
+  bst_node_t header;
+  header.left = header.right = NULL;
+  bst_node_t *left = &header;   // largest node of the left part
+  bst_node_t *right = &header;  // smallest node of the right part
+#ifdef BST_ORDER_STATISTICS
+  int left_size = 0;
+  int right_size = 0;
+#endif
+
+  while (true) {
+    if (key < tree->key) {
+      if (tree->left == NULL) {
+        break;
+      }
+      if (key < tree->left->key) { // zig-zig: rotate right first
+        bst_node_t *child = tree->left;
+        tree->left = child->right;
+        child->right = tree;
+        BST_UPDATE_SIZE(tree);
+        tree = child;
+        if (tree->left == NULL) {
+          break;
+        }
+      }
+      right->left = tree; // link to the right part
+      right = tree;
+      tree = tree->left;
+#ifdef BST_ORDER_STATISTICS
+      right_size += 1 + bst_size(right->right);
+#endif
+    }
+    else if (key > tree->key) {
+      if (tree->right == NULL) {
+        break;
+      }
+      if (key > tree->right->key) { // zig-zig: rotate left first
+        bst_node_t *child = tree->right;
+        tree->right = child->left;
+        child->left = tree;
+        BST_UPDATE_SIZE(tree);
+        tree = child;
+        if (tree->right == NULL) {
+          break;
+        }
+      }
+      left->right = tree; // link to the left part
+      left = tree;
+      tree = tree->right;
+#ifdef BST_ORDER_STATISTICS
+      left_size += 1 + bst_size(left->left);
+#endif
+    }
+    else {
+      break;
+    }
+  }
+
+#ifdef BST_ORDER_STATISTICS
+  // the spines hold stale sizes, walk them from the top with the running totals
+  left_size += bst_size(tree->left);
+  right_size += bst_size(tree->right);
+  tree->size = left_size + right_size + 1;
+  left->right = right->left = NULL;
+  for (bst_node_t *node = header.right; node != NULL; node = node->right) {
+    node->size = left_size;
+    left_size -= 1 + bst_size(node->left);
+  }
+  for (bst_node_t *node = header.left; node != NULL; node = node->left) {
+    node->size = right_size;
+    right_size -= 1 + bst_size(node->right);
+  }
+#endif
+
+  // assemble: the parts become the subtrees of the new root
+  left->right = tree->left;
+  right->left = tree->right;
+  tree->left = header.right;
+  tree->right = header.left;
+  return tree;
+}
+
+/*
+ * Vyhledání uzlu se splayem. Nalezený uzel (jinak poslední uzel na cestě)
+ * se stane kořenem. Sémantika value je stejná jako u bst_search.
+ */
+bool bst_splay_search(bst_node_t **tree, int key, bst_node_content_t **value)
+{
+  *tree = bst_splay(*tree, key);
+  if (*tree == NULL || (*tree)->key != key) {
+    return false;
+  }
+  *value = &(*tree)->content;
+  return true;
+}
+
+/*
+ * Vložení uzlu se splayem, vložený uzel se stane kořenem. Existující klíč
+ * dostane novou hodnotu a stará hodnota se uvolní.
+ */
+void bst_splay_insert(bst_node_t **tree, int key, bst_node_content_t value)
+{
+  bst_node_t *root = bst_splay(*tree, key);
+  if (root != NULL && root->key == key) {
+    if (root->content.value != NULL) {
+      free(root->content.value);
+    }
+    root->content = value;
+    *tree = root;
+    return;
+  }
+
+  bst_node_t *node = malloc(sizeof(bst_node_t));
+  if (node == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  node->key = key;
+  node->content = value;
+  node->left = node->right = NULL;
+  if (root != NULL && key < root->key) { // root and its right subtree go right
+    node->left = root->left;
+    node->right = root;
+    root->left = NULL;
+    BST_UPDATE_SIZE(root);
+  }
+  else if (root != NULL) {
+    node->right = root->right;
+    node->left = root;
+    root->right = NULL;
+    BST_UPDATE_SIZE(root);
+  }
+  BST_UPDATE_SIZE(node);
+  *tree = node;
+}
+
+/*
+ * Smazání uzlu se splayem. Klíč se přesune do kořene a levý podstrom se
+ * splayem na stejný klíč (větší než všechny jeho klíče) zvedne za největší
+ * uzel, který pak nemá pravého potomka a převezme pravý podstrom.
+ */
+void bst_splay_delete(bst_node_t **tree, int key)
+{
+  bst_node_t *root = bst_splay(*tree, key);
+  if (root == NULL || root->key != key) {
+    *tree = root;
+    return;
+  }
+
+  if (root->left == NULL) {
+    *tree = root->right;
+  }
+  else {
+    bst_node_t *joined = bst_splay(root->left, key);
+    joined->right = root->right;
+    BST_UPDATE_SIZE(joined);
+    *tree = joined;
+  }
+  if (root->content.value != NULL) {
+    free(root->content.value);
+  }
+  free(root);
+}
+
+/*
+ * Rozdělení stromu podle klíče key se splayem (amortizovaně O(log n)). Po
+ * splayi je kořen nejbližší uzel ke key, stačí od něj odtrhnout jeden
+ * podstrom. Sémantika je stejná jako u bst_split.
+ */
+void bst_splay_split(bst_node_t *tree, int key, bst_node_t **lt, bst_node_t **ge)
+{
+  tree = bst_splay(tree, key);
+  if (tree == NULL) {
+    *lt = *ge = NULL;
+  }
+  else if (tree->key < key) {
+    *ge = tree->right;
+    tree->right = NULL;
+    BST_UPDATE_SIZE(tree);
+    *lt = tree;
+  }
+  else {
+    *lt = tree->left;
+    tree->left = NULL;
+    BST_UPDATE_SIZE(tree);
+    *ge = tree;
+  }
+}
+
+/*
+ * Spojení dvou stromů se splayem (amortizovaně O(log n)), všechny klíče
+ * stromu a musí být menší než klíče stromu b. Splay na největší klíč
+ * zvedne největší uzel stromu a do kořene, kde nemá pravého potomka.
+ */
+bst_node_t *bst_splay_join(bst_node_t *a, bst_node_t *b)
+{
+  if (a == NULL) {
+    return b;
+  }
+  a = bst_splay(a, INT_MAX);
+  a->right = b;
+  BST_UPDATE_SIZE(a);
+  return a;
+}
@@ -0,0 +1,31 @@
+/*
+ * Hlavičkový soubor pro splay variantu binárního vyhledávacího stromu.
+ *
+ * Splay strom používá stejné uzly jako bst_*, jen vyhledávání, vkládání
+ * a mazání hledaný klíč (nebo poslední uzel na cestě k němu) přesune do
+ * kořene. Často hledané klíče tak zůstávají u kořene a posloupnost operací
+ * má amortizovanou cenu O(log n) na operaci. Vyhledávání proto mění tvar
+ * stromu a potřebuje ukazatel na kořen.
+ *
+ * Splay je shora dolů (top-down) a iterativní: jediný průchod od kořene
+ * rozebírá strom na levou a pravou část a nakonec je pověsí pod nový kořen,
+ * bez zásobníku i bez ukazatelů na rodiče. S BST_ORDER_STATISTICS se
+ * velikosti podstromů opraví jedním průchodem po okrajích obou částí.
+ *
+ * Průchody, bst_dispose a další funkce nad bst_node_t fungují i na splay
+ * stromu, bst_insert a bst_delete na něj použít lze, jen nic nepřesunou.
+ */
+
+#ifndef IAL_BTREE_SPLAY_H
+#define IAL_BTREE_SPLAY_H
+
+#include "btree.h"
+
+bst_node_t *bst_splay(bst_node_t *tree, int key);
+bool bst_splay_search(bst_node_t **tree, int key, bst_node_content_t **value);
+void bst_splay_insert(bst_node_t **tree, int key, bst_node_content_t value);
+void bst_splay_delete(bst_node_t **tree, int key);
+void bst_splay_split(bst_node_t *tree, int key, bst_node_t **lt, bst_node_t **ge);
+bst_node_t *bst_splay_join(bst_node_t *a, bst_node_t *b);
+
+#endif
@@ -1,5 +1,19 @@
 #include "btree.h"
+#include "character.h"
+#include "character_table.h"
+#include "columns.h"
+#include "mapped.h"
+#include "parallel.h"
+#include "serialize.h"
+#include "splay.h"
 #include "test_util.h"
+#include "topk.h"
+#ifdef EXA
+#include "exa/btree-exa.h"
+#include "exa/ngram.h"
+#endif
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -16,6 +30,9 @@ const int traversal_data_count = 5;
 const char traversal_keys[] = {'D', 'B', 'A', 'C', 'E'};
 const int traversal_values[] = {1, 2, 3, 4, 5};
 
+const int degenerate_data_count = 40;
+const char degenerate_keys[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcd";
+
 void init_test() {
   printf("Binary Search Tree - testing script\n");
   printf("-----------------------------------\n");
@@ -85,6 +102,26 @@ bst_print_tree(test_tree);
 bst_print_search_result(result);
 ENDTEST
 
+TEST(test_tree_bounds, "Lower and upper bound of a present (F) and a missing (P) key")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_print_bound_result(bst_lower_bound(test_tree, 'F'));
+bst_print_bound_result(bst_upper_bound(test_tree, 'F'));
+bst_print_bound_result(bst_lower_bound(test_tree, 'P'));
+bst_print_bound_result(bst_upper_bound(test_tree, 'P'));
+bst_print_bound_result(bst_lower_bound(test_tree, '0'));
+ENDTEST
+
+TEST(test_tree_range, "Visit the keys in ranges [C,J) and [P,Z)")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_range(test_tree, 'C', 'J', bst_items_visit, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_range(test_tree, 'P', 'Z', bst_items_visit, test_items);
+bst_print_items(test_items);
+ENDTEST
+
 TEST(test_tree_delete_leaf, "Delete a leaf node (A)")
 bst_init(&test_tree);
 bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
@@ -174,14 +211,859 @@ bst_print_tree(test_tree);
 bst_print_items(test_items);
 ENDTEST
 
+TEST(test_tree_traverse_degenerate, "Traverse right and left degenerate trees of depth 40")
+bst_init(&test_tree);
+for (int i = 0; i < degenerate_data_count; i++) {
+  bst_insert(&test_tree, degenerate_keys[i], create_integer_content(i));
+}
+bst_preorder(test_tree, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_inorder(test_tree, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_postorder(test_tree, test_items);
+bst_print_items(test_items);
+bst_dispose(&test_tree);
+
+// descending keys build a left chain, preorder and inorder stacks grow too
+bst_init(&test_tree);
+for (int i = degenerate_data_count - 1; i >= 0; i--) {
+  bst_insert(&test_tree, degenerate_keys[i], create_integer_content(i));
+}
+bst_reset_items(test_items);
+bst_preorder(test_tree, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_inorder(test_tree, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_postorder(test_tree, test_items);
+bst_print_items(test_items);
+ENDTEST
+
+TEST(test_tree_morris_preorder, "Traverse the tree using Morris preorder")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, traversal_keys, traversal_values, traversal_data_count);
+bst_morris_preorder(test_tree, bst_items_visit, test_items);
+bst_print_tree(test_tree);
+bst_print_items(test_items);
+ENDTEST
+
+TEST(test_tree_morris_inorder, "Traverse the tree using Morris inorder")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_morris_inorder(test_tree, bst_items_visit, test_items);
+bst_print_tree(test_tree);
+bst_print_items(test_items);
+ENDTEST
+
+TEST(test_tree_cursor, "Pull the first items of each order from a cursor")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_cursor_t cursor;
+bst_cursor_init(&cursor, test_tree, BST_PREORDER);
+bst_print_cursor(&cursor, 4);
+bst_cursor_dispose(&cursor);
+bst_cursor_init(&cursor, test_tree, BST_INORDER);
+bst_print_cursor(&cursor, 4);
+bst_cursor_dispose(&cursor);
+bst_cursor_init(&cursor, test_tree, BST_POSTORDER);
+bst_print_cursor(&cursor, base_data_count + 1);
+bst_cursor_dispose(&cursor);
+ENDTEST
+
+TEST(test_tree_cursor_seek, "Seek the cursor to a key (F) and to a missing key (U)")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_cursor_t cursor;
+bst_cursor_init(&cursor, test_tree, BST_PREORDER);
+bst_cursor_seek(&cursor, 'F');
+bst_print_cursor(&cursor, base_data_count);
+bst_cursor_dispose(&cursor);
+bst_cursor_init(&cursor, test_tree, BST_INORDER);
+bst_cursor_seek(&cursor, 'F');
+bst_print_cursor(&cursor, 4);
+bst_cursor_seek(&cursor, 'U');
+bst_print_cursor(&cursor, 4);
+bst_cursor_dispose(&cursor);
+bst_cursor_init(&cursor, test_tree, BST_POSTORDER);
+bst_cursor_seek(&cursor, 'F');
+bst_print_cursor(&cursor, base_data_count);
+bst_cursor_dispose(&cursor);
+ENDTEST
+
+TEST(test_tree_cursor_degenerate, "Pull all items of a degenerate tree from a cursor")
+bst_init(&test_tree);
+for (int i = degenerate_data_count - 1; i >= 0; i--) {
+  bst_insert(&test_tree, degenerate_keys[i], create_integer_content(i));
+}
+bst_cursor_t cursor;
+bst_cursor_init(&cursor, test_tree, BST_POSTORDER);
+bst_print_cursor(&cursor, degenerate_data_count);
+bst_cursor_dispose(&cursor);
+ENDTEST
+
+TEST(test_tree_build_sorted, "Build a balanced tree from sorted keys")
+const int count = base_data_count;
+int keys[count];
+bst_node_content_t values[count];
+for (int i = 0; i < count; i++) {
+  keys[i] = 'A' + i;
+  values[i] = create_integer_content(i + 1);
+}
+bst_build_sorted(&test_tree, keys, values, count);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_tree_bulk_insert, "Merge a sorted batch (C,F,P,Q) into a tree")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, traversal_keys, traversal_values, traversal_data_count);
+const int keys[] = {'C', 'F', 'P', 'Q'};
+bst_node_content_t values[] = {
+    create_integer_content(30), create_integer_content(60),
+    create_integer_content(160), create_integer_content(170)};
+bst_bulk_insert(&test_tree, keys, values, 4);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_tree_balance, "Balance a degenerate tree")
+bst_init(&test_tree);
+for (int i = 0; i < base_data_count; i++) {
+  bst_insert(&test_tree, degenerate_keys[i], create_integer_content(i));
+}
+bst_balance(&test_tree);
+bst_print_tree(test_tree);
+ENDTEST
+
+long integer_value(bst_node_t *node, void *ctx) {
+  return *(int *)node->content.value;
+}
+
+long sum(long left, long right) {
+  return left + right;
+}
+
+void count_node(bst_node_t *node, void *ctx) {
+  atomic_fetch_add((atomic_int *)ctx, 1);
+}
+
+TEST(test_tree_parallel_inorder, "Traverse the tree using parallel inorder (4 threads)")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_parallel_inorder(test_tree, test_items, 4);
+bst_print_items(test_items);
+bst_dispose(&test_tree);
+const direction_t chains[] = {left, right};
+for (int d = 0; d < 2; d++) {
+  test_tree = bst_build_chain(200000, chains[d]);
+  bst_reset_items(test_items);
+  bst_parallel_inorder(test_tree, test_items, 4);
+  printf("%s chain: ", chains[d] == left ? "Left" : "Right");
+  bst_print_items_summary(test_items);
+  bst_dispose(&test_tree);
+}
+ENDTEST
+
+TEST(test_tree_parallel_reduce, "Sum and count the values in parallel (4 threads)")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+printf("Sum of values: %ld\n", bst_parallel_reduce(test_tree, integer_value, sum, 0, NULL, 4));
+atomic_int visited;
+atomic_init(&visited, 0);
+bst_parallel_for_each(test_tree, count_node, &visited, 4);
+printf("Visited nodes: %d\n", atomic_load(&visited));
+ENDTEST
+
+TEST(test_tree_parallel_dispose, "Dispose a degenerate tree in parallel (4 threads)")
+bst_init(&test_tree);
+for (int i = 0; i < degenerate_data_count; i++) {
+  bst_insert(&test_tree, degenerate_keys[i], create_integer_content(i));
+}
+bst_parallel_dispose(&test_tree, 4);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_tree_degenerate_million, "Operations on degenerate trees of a million nodes")
+const int count = 1000000;
+const direction_t directions[] = {right, left};
+for (int d = 0; d < 2; d++) {
+  test_tree = bst_build_chain(count, directions[d]);
+  int deepest = directions[d] == right ? count - 1 : 0;
+  int beyond = directions[d] == right ? count : -1;
+  printf("%s chain\n", directions[d] == right ? "Right" : "Left");
+  bst_node_content_t *result = NULL;
+  bst_search(test_tree, deepest, &result);
+  bst_print_search_result(result);
+  bst_insert(&test_tree, beyond, create_integer_content(beyond));
+  bst_insert(&test_tree, deepest, create_integer_content(-1));
+  result = NULL;
+  bst_search(test_tree, deepest, &result);
+  bst_print_search_result(result);
+  bst_delete(&test_tree, beyond);
+  bst_delete(&test_tree, count / 2);
+  bst_print_bound_result(bst_lower_bound(test_tree, count / 2));
+  bst_print_bound_result(bst_upper_bound(test_tree, count - 2));
+  bst_range(test_tree, count / 2 - 3, count / 2 + 3, bst_items_visit, test_items);
+  bst_print_items_summary(test_items);
+  bst_reset_items(test_items);
+  bst_preorder(test_tree, test_items);
+  bst_print_items_summary(test_items);
+  bst_reset_items(test_items);
+  bst_inorder(test_tree, test_items);
+  bst_print_items_summary(test_items);
+  bst_reset_items(test_items);
+  bst_postorder(test_tree, test_items);
+  bst_print_items_summary(test_items);
+  bst_reset_items(test_items);
+#ifdef BST_ORDER_STATISTICS
+  printf("Size: %d\n", bst_size(test_tree));
+#endif
+  bst_dispose(&test_tree);
+}
+ENDTEST
+
+TEST(test_tree_splay, "Splay searched, inserted and deleted keys to the root")
+bst_init(&test_tree);
+for (int i = 0; i < base_data_count; i++) {
+  bst_splay_insert(&test_tree, base_keys[i], create_integer_content(base_values[i]));
+}
+bst_print_tree(test_tree);
+bst_node_content_t *content;
+bst_splay_search(&test_tree, 'B', &content);
+printf("After searching B:\n");
+bst_print_tree(test_tree);
+bool found = bst_splay_search(&test_tree, 'U', &content);
+printf("Search U: %s, root %c\n", found ? "found" : "missing", test_tree->key);
+bst_splay_delete(&test_tree, 'H');
+bst_splay_delete(&test_tree, 'U');
+bst_splay_insert(&test_tree, 'B', create_integer_content(20));
+printf("After deleting H and U and updating B:\n");
+bst_print_tree(test_tree);
+#ifdef BST_ORDER_STATISTICS
+bst_print_order_statistics(test_tree);
+#endif
+ENDTEST
+
+TEST(test_tree_splay_random, "Random splay operations keep the tree ordered")
+bst_init(&test_tree);
+bool present[1000] = {false};
+int expected = 0;
+bool consistent = true;
+unsigned seed = 11;
+for (int i = 0; i < 20000; i++) {
+  seed = seed * 1103515245u + 12345u;
+  int key = (seed >> 8) % 1000;
+  bst_node_content_t *content;
+  switch (i % 3) {
+  case 0:
+    expected += !present[key];
+    present[key] = true;
+    bst_splay_insert(&test_tree, key, create_integer_content(key));
+    break;
+  case 1:
+    expected -= present[key];
+    present[key] = false;
+    bst_splay_delete(&test_tree, key);
+    break;
+  default:
+    consistent = consistent &&
+                 bst_splay_search(&test_tree, key, &content) == present[key] &&
+                 (!present[key] || (test_tree->key == key &&
+                                    *(int *)content->value == key));
+  }
+}
+bst_inorder(test_tree, test_items);
+for (int i = 1; i < test_items->size; i++) {
+  consistent = consistent && test_items->nodes[i - 1]->key < test_items->nodes[i]->key;
+}
+printf("Nodes: %d (expected %d), ordered and found: %s\n", test_items->size,
+       expected, consistent ? "yes" : "no");
+#ifdef BST_ORDER_STATISTICS
+printf("Subtree sizes: %s\n",
+       bst_check_sizes(test_tree) == expected ? "consistent" : "inconsistent");
+#endif
+ENDTEST
+
+TEST(test_tree_split_join, "Split the tree at a key and join the parts back")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_node_t *lt;
+bst_node_t *ge;
+bst_split(test_tree, 'F', &lt, &ge);
+printf("Keys below F:\n");
+bst_print_tree(lt);
+printf("Keys from F:\n");
+bst_print_tree(ge);
+test_tree = bst_join(lt, ge);
+printf("Joined:\n");
+bst_print_tree(test_tree);
+bst_split(test_tree, 'A', &lt, &ge);
+printf("Split at A: %s below, %s from\n", lt == NULL ? "none" : "some",
+       ge == NULL ? "none" : "some");
+test_tree = bst_join(lt, ge);
+bst_split(test_tree, 'Z', &lt, &ge);
+printf("Split at Z: %s below, %s from\n", lt == NULL ? "none" : "some",
+       ge == NULL ? "none" : "some");
+test_tree = bst_join(lt, ge);
+bst_splay_split(test_tree, 'K', &lt, &ge);
+printf("Splay split at K, roots %c and %c\n", lt->key, ge->key);
+test_tree = bst_splay_join(lt, ge);
+bst_inorder(test_tree, test_items);
+bst_print_items(test_items);
+#ifdef BST_ORDER_STATISTICS
+bst_print_order_statistics(test_tree);
+#endif
+ENDTEST
+
+TEST(test_tree_union, "Union of two trees, the second one wins on equal keys")
+bst_init(&test_tree);
+bst_node_t *other;
+bst_init(&other);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_insert_many(&other, additional_keys, additional_values, additional_data_count);
+bst_insert(&other, 'H', create_integer_content(80));
+bst_insert(&other, 'A', create_integer_content(100));
+test_tree = bst_union(test_tree, other);
+bst_print_tree(test_tree);
+#ifdef BST_ORDER_STATISTICS
+bst_print_order_statistics(test_tree);
+#endif
+bst_node_t *empty = NULL;
+test_tree = bst_union(test_tree, empty);
+bst_inorder(test_tree, test_items);
+printf("Union with an empty tree: %d nodes\n", test_items->size);
+ENDTEST
+
+TEST(test_tree_split_join_random, "Split and join at random keys")
+bst_init(&test_tree);
+int keys[1000];
+bst_node_content_t values[1000];
+for (int i = 0; i < 1000; i++) {
+  keys[i] = 3 * i;
+  values[i] = create_integer_content(i);
+}
+bst_build_sorted(&test_tree, keys, values, 1000);
+bool consistent = true;
+unsigned seed = 5;
+for (int round = 0; round < 200; round++) {
+  seed = seed * 1103515245u + 12345u;
+  int key = (seed >> 8) % 3100 - 50;
+  bst_node_t *lt;
+  bst_node_t *ge;
+  if (round % 2 == 0) {
+    bst_split(test_tree, key, &lt, &ge);
+  }
+  else {
+    bst_splay_split(test_tree, key, &lt, &ge);
+  }
+  bst_reset_items(test_items);
+  bst_inorder(lt, test_items);
+  int below = test_items->size;
+  consistent = consistent &&
+               (below == 0 || test_items->nodes[below - 1]->key < key);
+  bst_reset_items(test_items);
+  bst_inorder(ge, test_items);
+  consistent = consistent && below + test_items->size == 1000 &&
+               (test_items->size == 0 || test_items->nodes[0]->key >= key);
+#ifdef BST_ORDER_STATISTICS
+  consistent = consistent && bst_check_sizes(lt) == below &&
+               bst_check_sizes(ge) == test_items->size;
+#endif
+  test_tree = round % 2 == 0 ? bst_join(lt, ge) : bst_splay_join(lt, ge);
+}
+bst_reset_items(test_items);
+bst_inorder(test_tree, test_items);
+for (int i = 0; i < test_items->size; i++) {
+  consistent = consistent && test_items->nodes[i]->key == 3 * i;
+}
+printf("200 splits and joins: %s\n", consistent ? "consistent" : "inconsistent");
+ENDTEST
+
+TEST(test_tree_serialize, "Serialize the tree and load it back")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+FILE *stream = tmpfile();
+bool saved = bst_serialize(test_tree, stream);
+printf("Serialized: %s, %ld bytes\n", saved ? "yes" : "no", ftell(stream));
+rewind(stream);
+bst_node_t *loaded;
+bool restored = bst_deserialize(&loaded, stream);
+printf("Loaded: %s\n", restored ? "yes" : "no");
+bst_print_tree(loaded);
+bst_preorder(loaded, test_items);
+bst_print_items(test_items);
+#ifdef BST_ORDER_STATISTICS
+bst_print_order_statistics(loaded);
+#endif
+bst_dispose(&loaded);
+fclose(stream);
+ENDTEST
+
+TEST(test_tree_serialize_character, "Serialize character values")
+bst_init(&test_tree);
+character_t *hero = malloc(sizeof(character_t));
+*hero = (character_t){.name = "Astarion", .character_class = Bard, .level = 7};
+bst_insert(&test_tree, -70000, (bst_node_content_t){.value = hero, .type = CHARACTER_T});
+bst_insert(&test_tree, 70000, create_integer_content(5));
+bst_insert(&test_tree, 0, (bst_node_content_t){.value = NULL, .type = INTEGER});
+FILE *stream = tmpfile();
+bst_serialize(test_tree, stream);
+printf("Serialized: %ld bytes\n", ftell(stream));
+rewind(stream);
+bst_node_t *loaded;
+printf("Loaded: %s\n", bst_deserialize(&loaded, stream) ? "yes" : "no");
+bst_node_content_t *result = NULL;
+bst_search(loaded, -70000, &result);
+printf("Search result: ");
+print_character(result->value);
+printf("\n");
+result = NULL;
+bst_search(loaded, 70000, &result);
+bst_print_search_result(result);
+result = NULL;
+bst_search(loaded, 0, &result);
+printf("Value of 0: %s\n", result != NULL && result->value == NULL ? "NULL" : "set");
+bst_dispose(&loaded);
+fclose(stream);
+ENDTEST
+
+TEST(test_tree_deserialize_invalid, "Reject truncated and unordered data")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+FILE *stream = tmpfile();
+bst_serialize(test_tree, stream);
+long length = ftell(stream);
+rewind(stream);
+char buffer[256];
+size_t read = fread(buffer, 1, sizeof(buffer), stream);
+fclose(stream);
+bst_node_t *loaded;
+for (long cut = 0; cut < length; cut += 13) {
+  stream = tmpfile();
+  fwrite(buffer, 1, cut, stream);
+  rewind(stream);
+  bool restored = bst_deserialize(&loaded, stream);
+  printf("Truncated to %ld of %zu bytes: %s, tree %s\n", cut, read,
+         restored ? "loaded" : "rejected", loaded == NULL ? "NULL" : "set");
+  fclose(stream);
+}
+// root 5 with a left child 7 breaks the ordering
+const char unordered[] = {'B', 'S', 'T', '1', 2, 1 | 4, 10, 4, 14};
+stream = tmpfile();
+fwrite(unordered, 1, sizeof(unordered), stream);
+rewind(stream);
+printf("Unordered: %s\n", bst_deserialize(&loaded, stream) ? "loaded" : "rejected");
+fclose(stream);
+ENDTEST
+
+void bst_print_mapped_visit(const bst_mapped_t *mapped,
+                            const bst_mapped_node_t *node, void *ctx)
+{
+  bst_mapped_print_node(mapped, node);
+}
+
+TEST(test_tree_mmap, "Export the tree and search it in the mapped file")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+character_t *hero = malloc(sizeof(character_t));
+*hero = (character_t){.name = "Shadowheart", .character_class = Cleric, .level = 5};
+bst_insert(&test_tree, 'Z', (bst_node_content_t){.value = hero, .type = CHARACTER_T});
+const char *path = "test_mmap.bst";
+printf("Exported: %s\n", bst_export_mmap(test_tree, path) ? "yes" : "no");
+bst_mapped_t mapped;
+bool opened = bst_open_mmap(&mapped, path);
+printf("Opened: %s, %u nodes of %zu bytes\n", opened ? "yes" : "no",
+       mapped.count, sizeof(bst_mapped_node_t));
+const bst_mapped_node_t *found = bst_mapped_search(&mapped, 'A');
+printf("Search result: ");
+bst_mapped_print_node(&mapped, found);
+printf("\nSearch result: ");
+bst_mapped_print_node(&mapped, bst_mapped_search(&mapped, 'Z'));
+printf("\nMissing (X): %s\n", bst_mapped_search(&mapped, 'X') ? "found" : "none");
+printf("Range [C,J):\n");
+bst_mapped_range(&mapped, 'C', 'J', bst_print_mapped_visit, NULL);
+printf("\nInorder:\n");
+bst_mapped_inorder(&mapped, bst_print_mapped_visit, NULL);
+printf("\n");
+bst_close_mmap(&mapped);
+remove(path);
+ENDTEST
+
+TEST(test_tree_mmap_invalid, "Reject truncated and corrupted mapped files")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+const char *path = "test_mmap.bst";
+bst_export_mmap(test_tree, path);
+FILE *stream = fopen(path, "rb");
+char buffer[512];
+size_t length = fread(buffer, 1, sizeof(buffer), stream);
+fclose(stream);
+bst_mapped_t mapped;
+stream = fopen(path, "wb");
+fwrite(buffer, 1, length - 4, stream);
+fclose(stream);
+printf("Truncated: %s\n", bst_open_mmap(&mapped, path) ? "opened" : "rejected");
+// the root's left child pointing back to the root would make a cycle
+bst_mapped_node_t *root = (bst_mapped_node_t *)(buffer + 12);
+root->left = 0;
+stream = fopen(path, "wb");
+fwrite(buffer, 1, length, stream);
+fclose(stream);
+printf("Cycle: %s\n", bst_open_mmap(&mapped, path) ? "opened" : "rejected");
+root->left = 1;
+root->key = 'A';
+stream = fopen(path, "wb");
+fwrite(buffer, 1, length, stream);
+fclose(stream);
+printf("Unordered: %s\n", bst_open_mmap(&mapped, path) ? "opened" : "rejected");
+printf("Missing file: %s\n",
+       bst_open_mmap(&mapped, "missing.bst") ? "opened" : "rejected");
+remove(path);
+ENDTEST
+
+TEST(test_tree_items_reuse, "Reuse traversal items and take them from an arena")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_items_reserve(test_items, base_data_count);
+bst_node_t **nodes = test_items->nodes;
+for (int round = 0; round < 3; round++) {
+  bst_items_clear(test_items);
+  bst_inorder(test_tree, test_items);
+}
+printf("Heap items: %d nodes, buffer kept: %s\n", test_items->size,
+       test_items->nodes == nodes ? "yes" : "no");
+
+bst_arena_t arena;
+bst_arena_init(&arena, 64);
+bool same = true;
+for (int round = 0; round < 3; round++) {
+  bst_items_t preorder;
+  bst_items_t postorder;
+  bst_items_init_arena(&preorder, &arena, 0);
+  bst_items_init_arena(&postorder, &arena, base_data_count);
+  bst_preorder(test_tree, &preorder);
+  bst_postorder(test_tree, &postorder);
+  same = same && preorder.size == base_data_count &&
+         postorder.size == base_data_count && preorder.nodes[0] == test_tree &&
+         postorder.nodes[base_data_count - 1] == test_tree;
+  bst_arena_reset(&arena);
+}
+printf("Arena items: %s, one block after reset: %s\n", same ? "correct" : "wrong",
+       arena.block->next == NULL && arena.block->capacity == arena.total ? "yes" : "no");
+bst_arena_dispose(&arena);
+ENDTEST
+
+TEST(test_tree_columns, "Export the tree into key, type and value columns")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_columns_t columns;
+bst_columns_init(&columns, base_data_count);
+const bst_order_t orders[] = {BST_PREORDER, BST_INORDER, BST_POSTORDER};
+const char *order_names[] = {"Preorder", "Inorder", "Postorder"};
+for (int o = 0; o < 3; o++) {
+  bst_columns_clear(&columns);
+  bst_columns_export(test_tree, orders[o], &columns);
+  bst_reset_items(test_items);
+  if (orders[o] == BST_PREORDER) {
+    bst_preorder(test_tree, test_items);
+  }
+  else if (orders[o] == BST_INORDER) {
+    bst_inorder(test_tree, test_items);
+  }
+  else {
+    bst_postorder(test_tree, test_items);
+  }
+  bool same = columns.size == test_items->size;
+  for (int i = 0; same && i < columns.size; i++) {
+    same = columns.keys[i] == test_items->nodes[i]->key &&
+           columns.values[i] == test_items->nodes[i]->content.value &&
+           columns.types[i] == INTEGER;
+  }
+  printf("%s:", order_names[o]);
+  for (int i = 0; i < columns.size; i++) {
+    printf(" %c", columns.keys[i]);
+  }
+  printf("\nSame as items: %s\n", same ? "yes" : "no");
+}
+printf("Sum of values: %lld\n", (long long)bst_columns_sum(&columns));
+printf("Keys in [D, K]: %d\n", bst_columns_count_range(&columns, 'D', 'K'));
+printf("Reused without growing: %s\n",
+       columns.capacity == base_data_count ? "yes" : "no");
+bst_columns_dispose(&columns);
+ENDTEST
+
+TEST(test_tree_top_k, "Find the 3 and 8 most frequent keys, ties by key")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_top_k(test_tree, 3, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_insert_many(&test_tree, additional_keys, additional_values,
+                additional_data_count);
+bst_top_k(test_tree, 8, test_items);
+bst_print_items(test_items);
+bst_reset_items(test_items);
+bst_top_k(test_tree, 100, test_items);
+printf("Top 100 of %d nodes: %d items\n", base_data_count + additional_data_count,
+       test_items->size);
+ENDTEST
+
+TEST(test_tree_heavy_hitters, "Approximate heavy hitters of a skewed stream")
+bst_init(&test_tree);
+space_saving_t summary;
+count_min_t sketch;
+space_saving_init(&summary, 16);
+count_min_init(&sketch, 256, 4);
+// key 1 every 3rd item, key 2 every 7th, key 3 every 11th, the rest unique
+int truth[4] = {0, 0, 0, 0};
+for (int i = 0; i < 100000; i++) {
+  int key = i % 3 == 0 ? 1 : i % 7 == 0 ? 2 : i % 11 == 0 ? 3 : 1000 + i;
+  if (key < 4) {
+    truth[key]++;
+  }
+  space_saving_add(&summary, key, 1);
+  count_min_add(&sketch, key, 1);
+}
+topk_counter_t top[3];
+int found = space_saving_top(&summary, top, 3);
+for (int i = 0; i < found; i++) {
+  printf("Space-Saving: key %d, true %d, within bound %s\n", top[i].key,
+         truth[top[i].key < 4 ? top[i].key : 0],
+         top[i].key < 4 && top[i].count - top[i].error <= (uint64_t)truth[top[i].key] &&
+                 (uint64_t)truth[top[i].key] <= top[i].count
+             ? "yes"
+             : "no");
+}
+for (int key = 1; key <= 3; key++) {
+  uint64_t estimate = count_min_estimate(&sketch, key);
+  printf("Count-Min: key %d, never below true count %s, error under 2%% %s\n", key,
+         estimate >= (uint64_t)truth[key] ? "yes" : "no",
+         estimate - truth[key] < 2000 ? "yes" : "no");
+}
+space_saving_dispose(&summary);
+count_min_dispose(&sketch);
+ENDTEST
+
+// Klíče nalezených postav pro výpis v pevném pořadí
+typedef struct character_keys {
+  int keys[64];
+  int count;
+} character_keys_t;
+
+void character_keys_visit(int key, character_t *character, void *ctx)
+{
+  (void)character;
+  character_keys_t *found = ctx;
+  if (found->count < 64) {
+    found->keys[found->count++] = key;
+  }
+}
+
+void character_keys_sum(int key, character_t *character, void *ctx)
+{
+  *(long long *)ctx += (long long)key * 256 + character->level;
+}
+
+int character_keys_compare(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+void character_table_print_query(character_table_t *table, const char *label,
+                                 character_query_t query)
+{
+  character_keys_t found = {.count = 0};
+  int count = character_table_query(table, &query, character_keys_visit, &found);
+  qsort(found.keys, found.count, sizeof(int), character_keys_compare);
+  printf("%s: %d\n", label, count);
+  for (int i = 0; i < found.count; i++) {
+    bst_node_content_t *content;
+    bst_search(table->tree, found.keys[i], &content);
+    printf("  %d: ", found.keys[i]);
+    print_character(content->value);
+    printf("\n");
+  }
+}
+
+TEST(test_character_table, "Query characters by name, class and level")
+bst_init(&test_tree);
+character_table_t table;
+character_table_init(&table, CHARACTER_INDEX_ALL);
+const character_t party[] = {
+    {"Gandalf", Wizard, 20},  {"Merlin", Wizard, 12},  {"Rincewind", Wizard, 3},
+    {"Tuck", Cleric, 7},      {"Gandalf", Bard, 5},    {"Arthur", Paladin, 9},
+    {"Conan", Fighter, 15},   {"Shaolin", Monk, 11},   {"Elminster", Wizard, 11},
+    {"Lancelot", Paladin, 5}, {"Rhiannon", Bard, 10},  {"Xena", Fighter, 4}};
+for (int i = 0; i < 12; i++) {
+  character_table_insert(&table, 10 * (i + 1), party[i]);
+}
+character_table_print_query(&table, "Wizards of level > 10",
+    (character_query_t){NULL, 1u << Wizard, 11, 255});
+character_table_print_query(&table, "Named Gandalf",
+    (character_query_t){"Gandalf", 0, 0, 255});
+character_table_print_query(&table, "Clerics and Paladins of level 5-9",
+    (character_query_t){NULL, 1u << Cleric | 1u << Paladin, 5, 9});
+character_table_print_query(&table, "Level 10-11",
+    (character_query_t){NULL, 0, 10, 11});
+// Gandalf the Wizard returns as a Fighter, Merlin leaves
+character_table_insert(&table, 10, (character_t){"Gandalf", Fighter, 21});
+character_table_delete(&table, 20);
+character_table_delete(&table, 1000);
+character_table_print_query(&table, "Wizards of level > 10",
+    (character_query_t){NULL, 1u << Wizard, 11, 255});
+character_table_print_query(&table, "Named Gandalf of level > 10",
+    (character_query_t){"Gandalf", 0, 11, 255});
+character_table_dispose(&table);
+ENDTEST
+
+TEST(test_character_table_many, "Compare indexed queries with a plain scan")
+bst_init(&test_tree);
+character_table_t indexed;
+character_table_t plain;
+character_table_init(&indexed, CHARACTER_INDEX_ALL);
+character_table_init(&plain, 0);
+char name[16];
+unsigned seed = 7;
+for (int i = 0; i < 20000; i++) {
+  seed = seed * 1103515245u + 12345u;
+  int key = (seed >> 8) % 5000;
+  if (i % 5 == 4) {
+    character_table_delete(&indexed, key);
+    character_table_delete(&plain, key);
+    continue;
+  }
+  snprintf(name, sizeof(name), "hero%u", (seed >> 4) % 50);
+  character_t hero = {name, (seed >> 12) % CHARACTER_CLASS_COUNT, (seed >> 16) % 40};
+  character_table_insert(&indexed, key, hero);
+  character_table_insert(&plain, key, hero);
+}
+const character_query_t queries[] = {
+    {NULL, 0, 0, 255},          {NULL, 1u << Monk, 0, 255},
+    {NULL, 0, 30, 35},          {NULL, 1u << Bard | 1u << Wizard, 10, 12},
+    {"hero7", 0, 0, 255},       {"hero7", 1u << Fighter, 20, 39},
+    {"nobody", 0, 0, 255},      {NULL, 0, 50, 60}};
+for (int i = 0; i < 8; i++) {
+  long long sum_index = 0;
+  long long sum_plain = 0;
+  int with_index =
+      character_table_query(&indexed, &queries[i], character_keys_sum, &sum_index);
+  int without = character_table_query(&plain, &queries[i], character_keys_sum, &sum_plain);
+  printf("Query %d: %s\n", i,
+         with_index == without && sum_index == sum_plain ? "same characters"
+                                                         : "different characters");
+}
+character_table_dispose(&indexed);
+character_table_dispose(&plain);
+ENDTEST
+
+#ifdef BST_ORDER_STATISTICS
+
+TEST(test_tree_order_statistics, "Rank and select after inserts and deletes")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_insert_many(&test_tree, additional_keys, additional_values,
+                additional_data_count);
+bst_insert(&test_tree, 'H', create_integer_content(80));
+bst_print_order_statistics(test_tree);
+bst_delete(&test_tree, 'L');
+bst_delete(&test_tree, 'A');
+bst_delete(&test_tree, 'X');
+bst_delete(&test_tree, 'U');
+bst_delete(&test_tree, 'H');
+bst_print_order_statistics(test_tree);
+bst_balance(&test_tree);
+bst_print_order_statistics(test_tree);
+printf("Rank of missing key (U): %d\n", bst_rank(test_tree, 'U'));
+ENDTEST
+
+#endif // BST_ORDER_STATISTICS
+
 #ifdef EXA
 
+const char letter_text[] = "Zebra ZEBRA zebra @[`{ \xc1\xe1\xff "
+                           "Abracadabra, abracadabra! Zz Yy 0123456789";
+
 TEST(test_letter_count, "Count letters");
 bst_init(&test_tree);
 letter_count(&test_tree, "abBcCc_ 123 *");
 bst_print_tree(test_tree);
 ENDTEST
 
+TEST(test_letter_count_long, "Count letters in a text longer than one block");
+bst_init(&test_tree);
+letter_count(&test_tree, (char *)letter_text);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_letter_count_stream, "Count letters fed in chunks of 5 bytes");
+letter_count_state_t state;
+letter_count_init(&state);
+for (size_t i = 0; i < sizeof(letter_text) - 1; i += 5) {
+  size_t left = sizeof(letter_text) - 1 - i;
+  letter_count_feed(&state, letter_text + i, left < 5 ? left : 5);
+}
+letter_count_finish(&state, &test_tree);
+bst_print_tree(test_tree);
+printf("Total of a: %llu\n", (unsigned long long)letter_count_total(&state, 'a'));
+printf("Totals of '{' and '|': %llu %llu\n",
+       (unsigned long long)letter_count_total(&state, '{'),
+       (unsigned long long)letter_count_total(&state, '|'));
+ENDTEST
+
+TEST(test_letter_count_file, "Count letters of a file in 4 threads");
+const char *path = "test_letters.txt";
+FILE *file = fopen(path, "wb");
+const int copies = 100000; // about 7 MB, enough for several threads
+for (int i = 0; i < copies; i++) {
+  fwrite(letter_text, 1, sizeof(letter_text) - 1, file);
+}
+fclose(file);
+bool counted = letter_count_file(&test_tree, path, 4);
+printf("Counted: %s\n", counted ? "yes" : "no");
+bst_print_tree(test_tree);
+remove(path);
+bst_dispose(&test_tree);
+printf("Missing file: %s\n",
+       letter_count_file(&test_tree, "missing.txt", 4) ? "counted" : "failed");
+ENDTEST
+
+void ngram_print_visit(bst_node_t *node, void *ctx)
+{
+  printf("%s: %d\n", ngram_token(ctx, node->key), *(int *)node->content.value);
+}
+
+const char ngram_text[] = "The cat sat on the mat. THE CAT ate; the cat's hat!";
+
+TEST(test_ngram_words, "Count words fed in chunks of 7 bytes");
+ngram_counter_t counter;
+ngram_init(&counter, 1);
+for (size_t i = 0; i < sizeof(ngram_text) - 1; i += 7) {
+  size_t left = sizeof(ngram_text) - 1 - i;
+  ngram_feed(&counter, ngram_text + i, left < 7 ? left : 7);
+}
+ngram_build_tree(&counter, &test_tree);
+bst_range(test_tree, INT_MIN, INT_MAX, ngram_print_visit, &counter);
+printf("Count of cat: %llu\n", (unsigned long long)ngram_count(&counter, "cat"));
+printf("Words from c to n:\n");
+bst_range(test_tree, ngram_key(&counter, "c"), ngram_key(&counter, "n"),
+          ngram_print_visit, &counter);
+ngram_dispose(&counter);
+ENDTEST
+
+TEST(test_ngram_bigrams, "Count pairs of words");
+ngram_counter_t counter;
+ngram_init(&counter, 2);
+ngram_feed(&counter, ngram_text, sizeof(ngram_text) - 1);
+ngram_build_tree(&counter, &test_tree);
+printf("Pairs starting with the:\n");
+bst_range(test_tree, ngram_key(&counter, "the "), ngram_key(&counter, "the!"),
+          ngram_print_visit, &counter);
+printf("Count of 'the cat': %llu\n",
+       (unsigned long long)ngram_count(&counter, "the cat"));
+ngram_dispose(&counter);
+ENDTEST
+
 #endif // EXA
 
 int main(int argc, char *argv[]) {
@@ -196,6 +1078,8 @@ int main(int argc, char *argv[]) {
   test_tree_insert_many();
   test_tree_search();
   test_tree_search_missing();
+  test_tree_bounds();
+  test_tree_range();
   test_tree_delete_leaf();
   test_tree_delete_left_subtree();
   test_tree_delete_right_subtree();
@@ -206,8 +1090,46 @@ int main(int argc, char *argv[]) {
   test_tree_preorder();
   test_tree_inorder();
   test_tree_postorder();
+  test_tree_traverse_degenerate();
+  test_tree_morris_preorder();
+  test_tree_morris_inorder();
+  test_tree_cursor();
+  test_tree_cursor_seek();
+  test_tree_cursor_degenerate();
+  test_tree_build_sorted();
+  test_tree_bulk_insert();
+  test_tree_balance();
+  test_tree_parallel_inorder();
+  test_tree_parallel_reduce();
+  test_tree_parallel_dispose();
+  test_tree_degenerate_million();
+  test_tree_splay();
+  test_tree_splay_random();
+  test_tree_split_join();
+  test_tree_union();
+  test_tree_split_join_random();
+  test_tree_serialize();
+  test_tree_serialize_character();
+  test_tree_deserialize_invalid();
+  test_tree_mmap();
+  test_tree_mmap_invalid();
+  test_tree_items_reuse();
+  test_tree_columns();
+  test_tree_top_k();
+  test_tree_heavy_hitters();
+  test_character_table();
+  test_character_table_many();
+
+#ifdef BST_ORDER_STATISTICS
+  test_tree_order_statistics();
+#endif // BST_ORDER_STATISTICS
 
 #ifdef EXA
   test_letter_count();
+  test_letter_count_long();
+  test_letter_count_stream();
+  test_letter_count_file();
+  test_ngram_words();
+  test_ngram_bigrams();
 #endif // EXA
 }
@@ -56,9 +56,7 @@ void bst_print_tree(bst_node_t *tree) {
 
 bst_items_t* bst_init_items() {
   bst_items_t* items = malloc(sizeof(bst_items_t));
-  items->capacity = 0;
-  items->nodes = NULL;
-  items->size = 0;
+  bst_items_init(items);
   return items;
 }
 
@@ -71,6 +69,15 @@ void bst_print_items(bst_items_t *items) {
   printf("\n");
 }
 
+void bst_print_cursor(bst_cursor_t *cursor, int count) {
+  printf("Cursor items:\n");
+  bst_node_t *node;
+  for (int i = 0; i < count && (node = bst_cursor_next(cursor)) != NULL; i++) {
+    bst_print_node(node);
+  }
+  printf("\n");
+}
+
 void bst_print_search_result(bst_node_content_t* content)
 {
   printf("Search result: ");
@@ -78,12 +85,24 @@ void bst_print_search_result(bst_node_content_t* content)
   printf("\n");
 }
 
+void bst_print_bound_result(bst_node_t *node)
+{
+  printf("Bound result: ");
+  if (node != NULL) {
+    bst_print_node(node);
+  } else {
+    printf("NULL");
+  }
+  printf("\n");
+}
+
 void bst_reset_items (bst_items_t *items) {
   if(items != NULL) {
-    if (items->capacity > 0)
+    if (items->capacity > 0 && items->arena == NULL)
     {
       free(items->nodes);
     }
+    items->nodes = NULL;
     items->capacity = 0;
     items->size = 0;
   }
@@ -106,3 +125,65 @@ void bst_insert_many(bst_node_t **tree, const char keys[], const int values[],
     bst_insert(tree, keys[i], create_integer_content(values[i]));
   }
 }
+
+bst_node_t *bst_build_chain(int count, direction_t direction) {
+  // linked bottom-up, inserting sorted keys one by one would take O(n^2)
+  bst_node_t *tree = NULL;
+  for (int i = count - 1; i >= 0; i--) {
+    bst_node_t *node = malloc(sizeof(bst_node_t));
+    if (node == NULL) {
+      exit(EXIT_FAILURE);
+    }
+    node->key = direction == right ? i : count - 1 - i;
+    node->content = create_integer_content(node->key);
+    node->left = direction == left ? tree : NULL;
+    node->right = direction == right ? tree : NULL;
+    BST_UPDATE_SIZE(node);
+    tree = node;
+  }
+  return tree;
+}
+
+void bst_print_items_summary(bst_items_t *items) {
+  printf("Items: %d", items->size);
+  if (items->size > 0) {
+    printf(", first %d, last %d", items->nodes[0]->key,
+           items->nodes[items->size - 1]->key);
+  }
+  printf("\n");
+}
+
+#ifdef BST_ORDER_STATISTICS
+int bst_check_sizes(bst_node_t *tree) {
+  if (tree == NULL) {
+    return 0;
+  }
+  int left = bst_check_sizes(tree->left);
+  int right = bst_check_sizes(tree->right);
+  if (left < 0 || right < 0 || tree->size != left + right + 1) {
+    return -1;
+  }
+  return tree->size;
+}
+
+void bst_print_order_statistics(bst_node_t *tree) {
+  int size = bst_check_sizes(tree);
+  if (size < 0) {
+    printf("Subtree sizes are inconsistent\n");
+    return;
+  }
+  printf("Subtree sizes consistent, %d nodes\n", size);
+  printf("Selected items:\n");
+  for (int k = 0; k <= size; k++) {
+    bst_node_t *node = bst_select(tree, k);
+    if (node != NULL) {
+      printf("%d", bst_rank(tree, node->key));
+      bst_print_node(node);
+    }
+    else {
+      printf("%d[NULL]", k);
+    }
+  }
+  printf("\n");
+}
+#endif
@@ -22,10 +22,18 @@ typedef enum direction { left, right, none } direction_t;
 void bst_print_subtree(bst_node_t *tree, char *prefix, direction_t from);
 void bst_print_tree(bst_node_t *tree);
 void bst_print_search_result(bst_node_content_t* content);
+void bst_print_bound_result(bst_node_t *node);
 bst_node_content_t create_integer_content(int value);
 void bst_insert_many(bst_node_t **tree, const char keys[], const int values[],
                      int count);
 bst_items_t* bst_init_items();
 void bst_print_items(bst_items_t *items);
 void bst_reset_items (bst_items_t *items);
+bst_node_t *bst_build_chain(int count, direction_t direction);
+void bst_print_items_summary(bst_items_t *items);
+#ifdef BST_ORDER_STATISTICS
+int bst_check_sizes(bst_node_t *tree);
+void bst_print_order_statistics(bst_node_t *tree);
+#endif
+void bst_print_cursor(bst_cursor_t *cursor, int count);
 #endif
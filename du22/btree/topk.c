@@ -0,0 +1,336 @@
+/*
+ * Hledání nejčastějších klíčů
+ *
+ * Přesné top-k nad stromem používá minimovou haldu k uzlů, v jejímž kořeni
+ * je nejhorší z dosud nejlepších. Space-Saving má haldu čítačů podle počtu
+ * a k ní hašovací tabulku z klíče na pozici v haldě, takže přičtení ke
+ * známému klíči i výměna nejmenšího čítače stojí O(log m).
+ */
+
+#include "topk.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Pomocná funkce pro porovnání uzlů: true, pokud je a horší než b (má menší
+ * hodnotu, při shodě větší klíč).
+ */
+static bool bst_top_worse(const bst_node_t *a, const bst_node_t *b)
+{
+  int value_a = *(int *)a->content.value;
+  int value_b = *(int *)b->content.value;
+  return value_a < value_b || (value_a == value_b && a->key > b->key);
+}
+
+static void bst_top_sift_down(bst_node_t **heap, int size, int index)
+{
+  while (true) {
+    int worst = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+    if (left < size && bst_top_worse(heap[left], heap[worst])) {
+      worst = left;
+    }
+    if (right < size && bst_top_worse(heap[right], heap[worst])) {
+      worst = right;
+    }
+    if (worst == index) {
+      return;
+    }
+    bst_node_t *tmp = heap[index];
+    heap[index] = heap[worst];
+    heap[worst] = tmp;
+    index = worst;
+  }
+}
+
+static void bst_top_sift_up(bst_node_t **heap, int index)
+{
+  while (index > 0 && bst_top_worse(heap[index], heap[(index - 1) / 2])) {
+    int parent = (index - 1) / 2;
+    bst_node_t *tmp = heap[index];
+    heap[index] = heap[parent];
+    heap[parent] = tmp;
+    index = parent;
+  }
+}
+
+/*
+ * Přidá do items nejvýše k uzlů s největší hodnotou, seřazené sestupně podle
+ * hodnoty (při shodě vzestupně podle klíče). Uzly bez hodnoty nebo s jiným
+ * typem hodnoty než INTEGER se přeskočí.
+ */
+void bst_top_k(bst_node_t *tree, int k, bst_items_t *items)
+{
+  if (k <= 0) {
+    return;
+  }
+  bst_node_t **heap = malloc(k * sizeof(bst_node_t *));
+  if (heap == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+
+  int size = 0;
+  bst_cursor_t cursor;
+  bst_cursor_init(&cursor, tree, BST_INORDER);
+  bst_node_t *node;
+  while ((node = bst_cursor_next(&cursor)) != NULL) {
+    if (node->content.value == NULL || node->content.type != INTEGER) {
+      continue;
+    }
+    if (size < k) {
+      heap[size++] = node;
+      bst_top_sift_up(heap, size - 1);
+    }
+    else if (bst_top_worse(heap[0], node)) { // replace the worst kept node
+      heap[0] = node;
+      bst_top_sift_down(heap, size, 0);
+    }
+  }
+  bst_cursor_dispose(&cursor);
+
+  // heap sort: the worst node goes to the end each time
+  for (int last = size - 1; last > 0; last--) {
+    bst_node_t *tmp = heap[0];
+    heap[0] = heap[last];
+    heap[last] = tmp;
+    bst_top_sift_down(heap, last, 0);
+  }
+  for (int i = 0; i < size; i++) {
+    bst_add_node_to_items(heap[i], items);
+  }
+  free(heap);
+}
+
+static int space_saving_hash(const space_saving_t *summary, int key)
+{
+  return ((uint64_t)(uint32_t)key * 0x9e3779b97f4a7c15ull >> 32) & summary->slots_mask;
+}
+
+/*
+ * Pozice klíče v hašovací tabulce, nebo volná pozice, kam patří.
+ */
+static int space_saving_find(const space_saving_t *summary, int key)
+{
+  int slot = space_saving_hash(summary, key);
+  while (summary->slots[slot] != -1 &&
+         summary->heap[summary->slots[slot]].key != key) {
+    slot = (slot + 1) & summary->slots_mask;
+  }
+  return slot;
+}
+
+/*
+ * Odstranění klíče z tabulky. Následující položky téhož shluku se posunou
+ * zpět, aby je vyhledávání stále našlo (bez náhrobků).
+ */
+static void space_saving_unlink(space_saving_t *summary, int key)
+{
+  int hole = space_saving_find(summary, key);
+  summary->slots[hole] = -1;
+  for (int slot = (hole + 1) & summary->slots_mask; summary->slots[slot] != -1;
+       slot = (slot + 1) & summary->slots_mask) {
+    int home = space_saving_hash(summary, summary->heap[summary->slots[slot]].key);
+    // the entry may move to the hole unless its home lies cyclically in (hole, slot]
+    bool stays = hole <= slot ? (home > hole && home <= slot)
+                              : (home > hole || home <= slot);
+    if (!stays) {
+      summary->slots[hole] = summary->slots[slot];
+      summary->slots[slot] = -1;
+      hole = slot;
+    }
+  }
+}
+
+static void space_saving_swap(space_saving_t *summary, int a, int b)
+{
+  // find both slots first, lookups compare the keys stored in the heap
+  int slot_a = space_saving_find(summary, summary->heap[a].key);
+  int slot_b = space_saving_find(summary, summary->heap[b].key);
+  topk_counter_t tmp = summary->heap[a];
+  summary->heap[a] = summary->heap[b];
+  summary->heap[b] = tmp;
+  summary->slots[slot_a] = b;
+  summary->slots[slot_b] = a;
+}
+
+static void space_saving_sift_down(space_saving_t *summary, int index)
+{
+  while (true) {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+    if (left < summary->size &&
+        summary->heap[left].count < summary->heap[smallest].count) {
+      smallest = left;
+    }
+    if (right < summary->size &&
+        summary->heap[right].count < summary->heap[smallest].count) {
+      smallest = right;
+    }
+    if (smallest == index) {
+      return;
+    }
+    space_saving_swap(summary, index, smallest);
+    index = smallest;
+  }
+}
+
+static void space_saving_sift_up(space_saving_t *summary, int index)
+{
+  while (index > 0 &&
+         summary->heap[index].count < summary->heap[(index - 1) / 2].count) {
+    space_saving_swap(summary, index, (index - 1) / 2);
+    index = (index - 1) / 2;
+  }
+}
+
+/*
+ * Inicializace souhrnu Space-Saving s capacity čítači.
+ */
+void space_saving_init(space_saving_t *summary, int capacity)
+{
+  summary->capacity = capacity > 0 ? capacity : 1;
+  summary->size = 0;
+  int slots = 2;
+  while (slots < 2 * summary->capacity) { // load factor at most 1/2
+    slots *= 2;
+  }
+  summary->slots_mask = slots - 1;
+  summary->heap = malloc(summary->capacity * sizeof(topk_counter_t));
+  summary->slots = malloc(slots * sizeof(int));
+  if (summary->heap == NULL || summary->slots == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  memset(summary->slots, -1, slots * sizeof(int));
+}
+
+/*
+ * Přičte count výskytů klíče key. Neznámý klíč při plném souhrnu nahradí
+ * čítač s nejmenším počtem a převezme jeho počet jako chybu.
+ */
+void space_saving_add(space_saving_t *summary, int key, uint64_t count)
+{
+  int slot = space_saving_find(summary, key);
+  if (summary->slots[slot] != -1) {
+    int index = summary->slots[slot];
+    summary->heap[index].count += count;
+    space_saving_sift_down(summary, index);
+    return;
+  }
+
+  if (summary->size < summary->capacity) {
+    int index = summary->size++;
+    summary->heap[index] = (topk_counter_t){.key = key, .count = count, .error = 0};
+    summary->slots[slot] = index;
+    space_saving_sift_up(summary, index);
+    return;
+  }
+
+  topk_counter_t *smallest = &summary->heap[0];
+  space_saving_unlink(summary, smallest->key);
+  uint64_t floor = smallest->count;
+  *smallest = (topk_counter_t){.key = key, .count = floor + count, .error = floor};
+  summary->slots[space_saving_find(summary, key)] = 0; // unlink moved the slots
+  space_saving_sift_down(summary, 0);
+}
+
+static int topk_counter_compare(const void *a, const void *b)
+{
+  const topk_counter_t *first = a;
+  const topk_counter_t *second = b;
+  if (first->count != second->count) {
+    return first->count < second->count ? 1 : -1;
+  }
+  return (first->key > second->key) - (first->key < second->key);
+}
+
+/*
+ * Zapíše do top nejvýše k čítačů s největším počtem seřazených sestupně
+ * a vrátí jejich počet.
+ */
+int space_saving_top(const space_saving_t *summary, topk_counter_t *top, int k)
+{
+  topk_counter_t *sorted = malloc((summary->size + 1) * sizeof(topk_counter_t));
+  if (sorted == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  memcpy(sorted, summary->heap, summary->size * sizeof(topk_counter_t));
+  qsort(sorted, summary->size, sizeof(topk_counter_t), topk_counter_compare);
+  int count = k < summary->size ? k : summary->size;
+  memcpy(top, sorted, (count > 0 ? count : 0) * sizeof(topk_counter_t));
+  free(sorted);
+  return count > 0 ? count : 0;
+}
+
+/*
+ * Uvolnění souhrnu Space-Saving.
+ */
+void space_saving_dispose(space_saving_t *summary)
+{
+  free(summary->heap);
+  free(summary->slots);
+  summary->heap = NULL;
+  summary->slots = NULL;
+  summary->size = 0;
+}
+
+/*
+ * Inicializace sketche Count-Min s depth řádky po width čítačích. Odhad je
+ * nadhodnocený nejvýše o e * n / width s pravděpodobností 1 - e^-depth.
+ */
+void count_min_init(count_min_t *sketch, int width, int depth)
+{
+  sketch->width = width > 0 ? width : 1;
+  sketch->depth = depth > 0 ? depth : 1;
+  sketch->counts = calloc((size_t)sketch->width * sketch->depth, sizeof(uint64_t));
+  if (sketch->counts == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+}
+
+// Sloupec klíče v řádku row (splitmix64 s jiným posunem pro každý řádek)
+static int count_min_column(const count_min_t *sketch, int key, int row)
+{
+  uint64_t x = (uint32_t)key + 0x9e3779b97f4a7c15ull * (row + 1);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x % sketch->width;
+}
+
+/*
+ * Přičte count výskytů klíče key.
+ */
+void count_min_add(count_min_t *sketch, int key, uint64_t count)
+{
+  for (int row = 0; row < sketch->depth; row++) {
+    sketch->counts[(size_t)row * sketch->width + count_min_column(sketch, key, row)] +=
+        count;
+  }
+}
+
+/*
+ * Odhad počtu výskytů klíče key (nikdy menší než skutečný počet).
+ */
+uint64_t count_min_estimate(const count_min_t *sketch, int key)
+{
+  uint64_t estimate = UINT64_MAX;
+  for (int row = 0; row < sketch->depth; row++) {
+    uint64_t count =
+        sketch->counts[(size_t)row * sketch->width + count_min_column(sketch, key, row)];
+    if (count < estimate) {
+      estimate = count;
+    }
+  }
+  return estimate;
+}
+
+/*
+ * Uvolnění sketche Count-Min.
+ */
+void count_min_dispose(count_min_t *sketch)
+{
+  free(sketch->counts);
+  sketch->counts = NULL;
+}
@@ -0,0 +1,57 @@
+/*
+ * Hlavičkový soubor pro hledání nejčastějších klíčů.
+ *
+ * bst_top_k najde k uzlů s největší hodnotou (typu INTEGER) v počítacím
+ * stromu, jako je výstup letter_count, bez řazení celého stromu: uzly
+ * prochází kurzorem a drží jen haldu k nejlepších, tedy O(n log k) času
+ * a O(k) paměti.
+ *
+ * Pro proudy s neomezeným počtem různých klíčů jsou tu dvě přibližné
+ * struktury s pevnou pamětí. Space-Saving drží m čítačů a každý klíč
+ * s četností nad n/m v nich určitě je, jeho počet je nadhodnocený nejvýše
+ * o uloženou chybu. Count-Min odhaduje četnost libovolného klíče shora,
+ * s chybou úměrnou n/width.
+ */
+
+#ifndef IAL_BTREE_TOPK_H
+#define IAL_BTREE_TOPK_H
+
+#include "btree.h"
+#include <stdint.h>
+
+void bst_top_k(bst_node_t *tree, int k, bst_items_t *items);
+
+// Čítač Space-Saving
+typedef struct topk_counter {
+  int key;          // klíč
+  uint64_t count;   // odhad počtu výskytů (horní mez)
+  uint64_t error;   // největší možné nadhodnocení count
+} topk_counter_t;
+
+// Souhrn Space-Saving
+typedef struct space_saving {
+  topk_counter_t *heap;   // čítače v minimové haldě podle count
+  int capacity;           // počet čítačů
+  int size;               // počet použitých čítačů
+  int *slots;             // hašovací tabulka klíč -> index v haldě, -1 = volno
+  int slots_mask;         // velikost tabulky - 1 (mocnina dvou)
+} space_saving_t;
+
+void space_saving_init(space_saving_t *summary, int capacity);
+void space_saving_add(space_saving_t *summary, int key, uint64_t count);
+int space_saving_top(const space_saving_t *summary, topk_counter_t *top, int k);
+void space_saving_dispose(space_saving_t *summary);
+
+// Sketch Count-Min
+typedef struct count_min {
+  uint64_t *counts;   // depth řádků po width čítačích
+  int width;          // počet čítačů v řádku
+  int depth;          // počet řádků (nezávislých hashů)
+} count_min_t;
+
+void count_min_init(count_min_t *sketch, int width, int depth);
+void count_min_add(count_min_t *sketch, int key, uint64_t count);
+uint64_t count_min_estimate(const count_min_t *sketch, int key);
+void count_min_dispose(count_min_t *sketch);
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Srovnání typovaného stromu postav s obecným stromem (iterativní varianta),
+ * kde je každá postava samostatně alokovaná hodnota typu CHARACTER_T.
+ *
+ * Použití: ./bench [počet klíčů]
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include "character_tree.h"
+#include "../btree.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NAMES 64
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void)
+{
+  // xorshift64
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+static void shuffle(int *keys, int count)
+{
+  for (int i = count - 1; i > 0; i--) {
+    int j = rng_next() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+}
+
+static void report(const char *tree, const char *op, double start, int count)
+{
+  printf("%-5s %-8s %8.1f ns/op\n", tree, op, (now_ns() - start) / count);
+}
+
+// Wizards of level 10 and more, the generic tree has to check the type first
+static void generic_visit(bst_node_t *node, void *ctx)
+{
+  if (node->content.type == CHARACTER_T && node->content.value != NULL) {
+    character_t *character = node->content.value;
+    if (character->character_class == Wizard && character->level >= 10) {
+      (*(long *)ctx)++;
+    }
+  }
+}
+
+static void typed_visit(int key, character_t *character, void *ctx)
+{
+  if (character->character_class == Wizard && character->level >= 10) {
+    (*(long *)ctx)++;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s [count]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int *keys = malloc(count * sizeof(int));
+  if (keys == NULL) {
+    return EXIT_FAILURE;
+  }
+  for (int i = 0; i < count; i++) {
+    keys[i] = i;
+  }
+  shuffle(keys, count);
+  char names[NAMES][16];
+  for (int i = 0; i < NAMES; i++) {
+    snprintf(names[i], sizeof(names[i]), "Hero %d", i);
+  }
+
+  long checksum = 0;
+  double start;
+  printf("%d random keys, %d distinct names\n\n", count, NAMES);
+
+  bst_node_t *generic;
+  bst_init(&generic);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    character_t *character = malloc(sizeof(character_t));
+    if (character == NULL) {
+      return EXIT_FAILURE;
+    }
+    *character = (character_t){.name = names[keys[i] % NAMES],
+                               .character_class = keys[i] % 6,
+                               .level = keys[i] % 20};
+    bst_insert(&generic, keys[i],
+               (bst_node_content_t){.value = character, .type = CHARACTER_T});
+  }
+  report("bst", "insert", start, count);
+  start = now_ns();
+  bst_morris_inorder(generic, generic_visit, &checksum);
+  report("bst", "scan", start, count);
+  start = now_ns();
+  bst_dispose(&generic);
+  report("bst", "dispose", start, count);
+
+  printf("\n");
+
+  character_tree_node_t *typed;
+  character_tree_init(&typed);
+  start = now_ns();
+  for (int i = 0; i < count; i++) {
+    character_tree_insert(&typed, keys[i],
+                          character_make(names[keys[i] % NAMES], keys[i] % 6,
+                                         keys[i] % 20));
+  }
+  report("typed", "insert", start, count);
+  start = now_ns();
+  character_tree_inorder(typed, typed_visit, &checksum);
+  report("typed", "scan", start, count);
+  start = now_ns();
+  character_tree_dispose(&typed);
+  report("typed", "dispose", start, count);
+  character_intern_clear();
+
+  printf("\nchecksum %ld\n", checksum);
+  free(keys);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*
+ * Typovaný strom postav a internování jmen
+ *
+ * Internovaná jména leží v blocích areny a hašovací tabulka s otevřeným
+ * adresováním z nich vybírá podle obsahu. Jména se nikdy nepřesouvají,
+ * ukazatele na ně platí až do character_intern_clear.
+ */
+
+#include "character_tree.h"
+#include <stdint.h>
+#include <string.h>
+
+TBST_DEFINE(character_tree, character_t)
+
+// Velikost bloku areny pro jména
+#define CHARACTER_INTERN_BLOCK (16 * 1024)
+
+// Blok areny
+typedef struct character_intern_block {
+  struct character_intern_block *next;  // předchozí blok
+  size_t used;                          // obsazené bajty
+  size_t capacity;                      // velikost dat v bajtech
+  char data[];                          // data
+} character_intern_block_t;
+
+static character_intern_block_t *intern_arena = NULL;
+static const char **intern_slots = NULL;  // tabulka jmen, NULL = volno
+static size_t intern_capacity = 0;        // velikost tabulky (mocnina dvou)
+static size_t intern_size = 0;            // počet jmen
+
+// FNV-1a
+static size_t character_intern_hash(const char *name)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (; *name != '\0'; name++) {
+    hash ^= (unsigned char)*name;
+    hash *= 0x100000001b3ull;
+  }
+  return hash ^ (hash >> 32);
+}
+
+static const char **character_intern_find(const char *name)
+{
+  size_t mask = intern_capacity - 1;
+  size_t index = character_intern_hash(name) & mask;
+  while (intern_slots[index] != NULL && strcmp(intern_slots[index], name) != 0) {
+    index = (index + 1) & mask;
+  }
+  return &intern_slots[index];
+}
+
+static void character_intern_grow(void)
+{
+  const char **old = intern_slots;
+  size_t old_capacity = intern_capacity;
+  intern_capacity = intern_capacity > 0 ? intern_capacity * 2 : 64;
+  intern_slots = calloc(intern_capacity, sizeof(const char *));
+  if (intern_slots == NULL) {
+    exit(EXIT_FAILURE); // error handling
+  }
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old[i] != NULL) {
+      *character_intern_find(old[i]) = old[i];
+    }
+  }
+  free(old);
+}
+
+/*
+ * Internovaná kopie jména name. Pro stejný text vrací vždy stejný ukazatel,
+ * pro NULL vrací NULL.
+ */
+const char *character_intern(const char *name)
+{
+  if (name == NULL) {
+    return NULL;
+  }
+  if ((intern_size + 1) * 4 > intern_capacity * 3) { // load factor at most 3/4
+    character_intern_grow();
+  }
+  const char **slot = character_intern_find(name);
+  if (*slot != NULL) {
+    return *slot;
+  }
+
+  size_t size = strlen(name) + 1;
+  character_intern_block_t *block = intern_arena;
+  if (block == NULL || block->used + size > block->capacity) {
+    size_t capacity = size > CHARACTER_INTERN_BLOCK ? size : CHARACTER_INTERN_BLOCK;
+    block = malloc(sizeof(character_intern_block_t) + capacity);
+    if (block == NULL) {
+      exit(EXIT_FAILURE); // error handling
+    }
+    block->next = intern_arena;
+    block->used = 0;
+    block->capacity = capacity;
+    intern_arena = block;
+  }
+  char *copy = block->data + block->used;
+  memcpy(copy, name, size);
+  block->used += size;
+  intern_size++;
+  *slot = copy;
+  return copy;
+}
+
+/*
+ * Uvolnění všech internovaných jmen. Postavy, které na ně ukazují, se po
+ * tomto volání nesmí používat.
+ */
+void character_intern_clear(void)
+{
+  while (intern_arena != NULL) {
+    character_intern_block_t *next = intern_arena->next;
+    free(intern_arena);
+    intern_arena = next;
+  }
+  free(intern_slots);
+  intern_slots = NULL;
+  intern_capacity = 0;
+  intern_size = 0;
+}
+
+/*
+ * Postava s internovaným jménem, připravená k vložení do character_tree.
+ */
+character_t character_make(const char *name, character_class_t character_class,
+                           unsigned char level)
+{
+  return (character_t){
+      .name = (char *)character_intern(name), // shared, must not be modified
+      .character_class = character_class,
+      .level = level};
+}
@@ -0,0 +1,24 @@
+/*
+ * Hlavičkový soubor pro typovaný strom postav.
+ *
+ * Postava character_t je uložená přímo v uzlu stromu character_tree. Jméno
+ * postavy je internované: každé jméno je v paměti jen jednou, postavy se
+ * stejným jménem sdílí stejný ukazatel a jména se dají porovnat ukazatelem.
+ * Internovaná jména se nesmí měnit ani uvolňovat jinak než funkcí
+ * character_intern_clear. Internování není vláknově bezpečné.
+ */
+
+#ifndef IAL_BTREE_CHARACTER_TREE_H
+#define IAL_BTREE_CHARACTER_TREE_H
+
+#include "../character.h"
+#include "tbst.h"
+
+TBST_DECLARE(character_tree, character_t)
+
+const char *character_intern(const char *name);
+void character_intern_clear(void);
+character_t character_make(const char *name, character_class_t character_class,
+                           unsigned char level);
+
+#endif
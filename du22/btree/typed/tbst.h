@@ -0,0 +1,155 @@
+/*
+ * Hlavičkový soubor pro binární vyhledávací strom s typovanou hodnotou.
+ *
+ * Makra vygenerují strom pro jeden konkrétní typ hodnoty TYPE. Hodnota je
+ * uložená přímo v uzlu (žádný ukazatel ani značka typu jako
+ * v bst_node_content_t), takže funkce nad stromem nemusí u každého uzlu
+ * rozhodovat podle typu a nealokují hodnotu zvlášť.
+ *
+ * TBST_DECLARE(PREFIX, TYPE) patří do hlavičkového souboru a deklaruje typy
+ * PREFIX_node_t, PREFIX_visit_t a funkce PREFIX_init, PREFIX_insert,
+ * PREFIX_search, PREFIX_delete, PREFIX_dispose a PREFIX_inorder.
+ * TBST_DEFINE(PREFIX, TYPE) patří do jednoho zdrojového souboru a funkce
+ * definuje. Hodnoty se kopírují, strom za ně nic neuvolňuje.
+ */
+
+#ifndef IAL_BTREE_TYPED_H
+#define IAL_BTREE_TYPED_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define TBST_DECLARE(PREFIX, TYPE)                                             \
+  typedef struct PREFIX##_node {                                               \
+    int key;                      /* klíč */                                   \
+    TYPE value;                   /* hodnota */                                \
+    struct PREFIX##_node *left;   /* levý potomek */                           \
+    struct PREFIX##_node *right;  /* pravý potomek */                          \
+  } PREFIX##_node_t;                                                           \
+                                                                               \
+  typedef void (*PREFIX##_visit_t)(int key, TYPE *value, void *ctx);           \
+                                                                               \
+  void PREFIX##_init(PREFIX##_node_t **tree);                                  \
+  void PREFIX##_insert(PREFIX##_node_t **tree, int key, TYPE value);           \
+  TYPE *PREFIX##_search(PREFIX##_node_t *tree, int key);                       \
+  void PREFIX##_delete(PREFIX##_node_t **tree, int key);                       \
+  void PREFIX##_dispose(PREFIX##_node_t **tree);                               \
+  void PREFIX##_inorder(PREFIX##_node_t *tree, PREFIX##_visit_t visit,         \
+                        void *ctx);
+
+#define TBST_DEFINE(PREFIX, TYPE)                                              \
+  void PREFIX##_init(PREFIX##_node_t **tree)                                   \
+  {                                                                            \
+    *tree = NULL;                                                              \
+  }                                                                            \
+                                                                               \
+  /* existing key: the value is replaced */                                    \
+  void PREFIX##_insert(PREFIX##_node_t **tree, int key, TYPE value)            \
+  {                                                                            \
+    while (*tree != NULL) {                                                    \
+      if (key == (*tree)->key) {                                               \
+        (*tree)->value = value;                                                \
+        return;                                                                \
+      }                                                                        \
+      tree = key < (*tree)->key ? &(*tree)->left : &(*tree)->right;            \
+    }                                                                          \
+    PREFIX##_node_t *node = malloc(sizeof(PREFIX##_node_t));                   \
+    if (node == NULL) {                                                        \
+      exit(EXIT_FAILURE); /* error handling */                                 \
+    }                                                                          \
+    node->key = key;                                                           \
+    node->value = value;                                                       \
+    node->left = NULL;                                                         \
+    node->right = NULL;                                                        \
+    *tree = node;                                                              \
+  }                                                                            \
+                                                                               \
+  /* pointer to the value in the node, or NULL */                              \
+  TYPE *PREFIX##_search(PREFIX##_node_t *tree, int key)                        \
+  {                                                                            \
+    while (tree != NULL) {                                                     \
+      if (key == tree->key) {                                                  \
+        return &tree->value;                                                   \
+      }                                                                        \
+      tree = key < tree->key ? tree->left : tree->right;                       \
+    }                                                                          \
+    return NULL;                                                               \
+  }                                                                            \
+                                                                               \
+  /* a node with two children takes over its left rightmost node */           \
+  void PREFIX##_delete(PREFIX##_node_t **tree, int key)                        \
+  {                                                                            \
+    while (*tree != NULL && (*tree)->key != key) {                             \
+      tree = key < (*tree)->key ? &(*tree)->left : &(*tree)->right;            \
+    }                                                                          \
+    PREFIX##_node_t *node = *tree;                                             \
+    if (node == NULL) {                                                        \
+      return;                                                                  \
+    }                                                                          \
+    if (node->left == NULL) {                                                  \
+      *tree = node->right;                                                     \
+    }                                                                          \
+    else if (node->right == NULL) {                                            \
+      *tree = node->left;                                                      \
+    }                                                                          \
+    else {                                                                     \
+      PREFIX##_node_t **rightmost = &node->left;                               \
+      while ((*rightmost)->right != NULL) {                                    \
+        rightmost = &(*rightmost)->right;                                      \
+      }                                                                        \
+      PREFIX##_node_t *replacement = *rightmost;                               \
+      node->key = replacement->key;                                            \
+      node->value = replacement->value;                                        \
+      *rightmost = replacement->left;                                          \
+      node = replacement;                                                      \
+    }                                                                          \
+    free(node);                                                                \
+  }                                                                            \
+                                                                               \
+  /* right rotations flatten the tree, no stack is needed */                   \
+  void PREFIX##_dispose(PREFIX##_node_t **tree)                                \
+  {                                                                            \
+    PREFIX##_node_t *node = *tree;                                             \
+    while (node != NULL) {                                                     \
+      if (node->left != NULL) {                                                \
+        PREFIX##_node_t *left = node->left;                                    \
+        node->left = left->right;                                              \
+        left->right = node;                                                    \
+        node = left;                                                           \
+      }                                                                        \
+      else {                                                                   \
+        PREFIX##_node_t *right = node->right;                                  \
+        free(node);                                                            \
+        node = right;                                                          \
+      }                                                                        \
+    }                                                                          \
+    *tree = NULL;                                                              \
+  }                                                                            \
+                                                                               \
+  /* Morris traversal, the tree is restored when it finishes */                \
+  void PREFIX##_inorder(PREFIX##_node_t *tree, PREFIX##_visit_t visit,         \
+                        void *ctx)                                             \
+  {                                                                            \
+    while (tree != NULL) {                                                     \
+      if (tree->left == NULL) {                                                \
+        visit(tree->key, &tree->value, ctx);                                   \
+        tree = tree->right;                                                    \
+        continue;                                                              \
+      }                                                                        \
+      PREFIX##_node_t *predecessor = tree->left;                               \
+      while (predecessor->right != NULL && predecessor->right != tree) {       \
+        predecessor = predecessor->right;                                      \
+      }                                                                        \
+      if (predecessor->right == NULL) {                                        \
+        predecessor->right = tree;                                             \
+        tree = tree->left;                                                     \
+      }                                                                        \
+      else {                                                                   \
+        predecessor->right = NULL;                                             \
+        visit(tree->key, &tree->value, ctx);                                   \
+        tree = tree->right;                                                    \
+      }                                                                        \
+    }                                                                          \
+  }
+
+#endif
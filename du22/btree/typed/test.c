@@ -0,0 +1,123 @@
+#include "character_tree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION)                                                \
+  void NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    character_tree_node_t *test_tree;                                          \
+    character_tree_init(&test_tree);
+
+#define ENDTEST                                                                \
+  printf("\n");                                                                \
+  character_tree_dispose(&test_tree);                                          \
+  }
+
+TBST_DECLARE(int_tree, int)
+TBST_DEFINE(int_tree, int)
+
+const int many_count = 1000;
+
+void print_int_visit(int key, int *value, void *ctx)
+{
+  printf("[%d,%d]", key, *value);
+}
+
+void sum_int_visit(int key, int *value, void *ctx)
+{
+  *(long *)ctx += *value;
+}
+
+void print_character_visit(int key, character_t *value, void *ctx)
+{
+  printf("%d: ", key);
+  print_character(value);
+  printf("\n");
+}
+
+// state[0] = minimum level, state[1] = count
+void count_wizards_visit(int key, character_t *value, void *ctx)
+{
+  int *state = ctx;
+  if (value->character_class == Wizard && value->level >= state[0]) {
+    state[1]++;
+  }
+}
+
+TEST(test_int_tree, "Insert, update, search and delete inline ints")
+int_tree_node_t *ints;
+int_tree_init(&ints);
+int keys[] = {50, 30, 70, 20, 40, 60, 80, 35, 45};
+for (int i = 0; i < 9; i++) {
+  int_tree_insert(&ints, keys[i], keys[i] * 10);
+}
+int_tree_insert(&ints, 40, 4);
+int *found = int_tree_search(ints, 40);
+printf("Search 40: %d\n", found != NULL ? *found : -1);
+printf("Search 41: %s\n", int_tree_search(ints, 41) != NULL ? "found" : "none");
+int_tree_delete(&ints, 20);
+int_tree_delete(&ints, 70);
+int_tree_delete(&ints, 50);
+int_tree_delete(&ints, 99);
+int_tree_inorder(ints, print_int_visit, NULL);
+printf("\nRoot: %d\n", ints->key);
+int_tree_dispose(&ints);
+printf("Node size: %zu bytes\n", sizeof(int_tree_node_t));
+ENDTEST
+
+TEST(test_int_tree_many, "Sum many inline ints without a type switch")
+int_tree_node_t *ints;
+int_tree_init(&ints);
+for (int i = 0; i < many_count; i++) {
+  int key = (i * 7919) % many_count;
+  int_tree_insert(&ints, key, key);
+}
+long sum = 0;
+int_tree_inorder(ints, sum_int_visit, &sum);
+printf("Sum: %ld\n", sum);
+for (int i = 0; i < many_count; i += 2) {
+  int_tree_delete(&ints, i);
+}
+sum = 0;
+int_tree_inorder(ints, sum_int_visit, &sum);
+printf("Sum of odd keys: %ld\n", sum);
+int_tree_dispose(&ints);
+ENDTEST
+
+TEST(test_character_tree, "Characters stored inline with interned names")
+char buffer[16];
+snprintf(buffer, sizeof(buffer), "%s", "Gale");
+character_tree_insert(&test_tree, 3, character_make(buffer, Wizard, 12));
+character_tree_insert(&test_tree, 1, character_make("Karlach", Fighter, 9));
+character_tree_insert(&test_tree, 5, character_make("Gale", Wizard, 4));
+character_tree_insert(&test_tree, 4, character_make("Lae'zel", Fighter, 11));
+character_tree_insert(&test_tree, 2, character_make("Wyll", Paladin, 10));
+buffer[0] = 'X'; // the interned copy does not change
+character_tree_inorder(test_tree, print_character_visit, NULL);
+character_t *first = character_tree_search(test_tree, 3);
+character_t *second = character_tree_search(test_tree, 5);
+printf("Names shared: %s\n", first->name == second->name ? "yes" : "no");
+printf("Interned again: %s\n", character_intern("Gale") == first->name ? "yes" : "no");
+int state[2] = {10, 0};
+character_tree_inorder(test_tree, count_wizards_visit, state);
+printf("Wizards of level 10 and more: %d\n", state[1]);
+character_tree_delete(&test_tree, 3);
+state[1] = 0;
+character_tree_inorder(test_tree, count_wizards_visit, state);
+printf("After deleting 3: %d\n", state[1]);
+printf("Node size: %zu bytes\n", sizeof(character_tree_node_t));
+ENDTEST
+
+int main(int argc, char *argv[])
+{
+  printf("Typed Binary Search Tree - testing script\n");
+  printf("-----------------------------------------\n");
+  printf("\n");
+
+  test_int_tree();
+  test_int_tree_many();
+  test_character_tree();
+  character_intern_clear();
+  printf("\n");
+  return 0;
+}